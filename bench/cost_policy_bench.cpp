@@ -0,0 +1,105 @@
+// Cost policy benchmark: edge cost updates along the paths the pattern
+// routers produce, with selcost dispatched per edge versus once per pass.
+//
+//   make bench
+//   ./bench/cost_policy_bench design.gr [passes] 2>/dev/null
+//
+// The design is routed through monotonic routing (HUM and refine off). Then
+// every two-pin is rerouted by patterns::Lshape, Zshape and Monotonic on the
+// routed costs, and per pattern and selcost the unit edges of those paths are
+// recosted `passes` times the way add_cost does:
+//   per-edge  an out-of-line CostModel::calc_cost call per edge, which
+//             branches on selcost (what add_cost did before cost policies)
+//   policy    CostModel::visit once, then BasicCostModel<Policy>::calc_cost
+//             inlined into the loop
+// Both must leave the same costs. Times are the best of 3.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "router/ispd_data.hpp"
+#include "router/patterns.hpp"
+#include "router/routing_core.hpp"
+#include "router/snapshot.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/utils.hpp"
+
+using namespace vlsigr;
+
+namespace {
+
+template<typename F>
+double best_of_3(F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, sec_since(start));
+    }
+    return best;
+}
+
+[[gnu::noinline]] EdgeCost calc_per_edge(const CostModel& cm, int demand, int cap, int he) {
+    return to_edge_cost(cm.calc_cost(demand, cap, he));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <design.gr|design.snap> [passes]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    const int passes = argc > 2 ? std::atoi(argv[2]) : 20;
+    auto data = is_snapshot_file(path) ? load_snapshot(path) : parse_ispd_file(path);
+
+    RoutingCore core;
+    RoutingCore::Config cfg;
+    cfg.enable_hum = false;
+    cfg.enable_refine = false;
+    core.set_config(cfg);
+    core.route(data, false);
+    SoAGridGraph grid = core.grid();
+
+    auto grid_cost = [&](int x, int y, bool hori) { return grid.cost(x, y, hori); };
+    using Router = void (*)(TwoPin&, const patterns::CostFn&);
+    const struct {
+        const char* name;
+        Router route;
+    } patterns[] = {{"Lshape", patterns::Lshape}, {"Zshape", patterns::Zshape}, {"Monotonic", patterns::Monotonic}};
+
+    std::printf("%zux%zu grid, %d passes\n", grid.width(), grid.height(), passes);
+    std::printf("%-10s %8s %10s %10s %10s %8s\n", "pattern", "selcost", "edges", "per-edge s", "policy s", "speedup");
+    for (auto& p : patterns) {
+        std::vector<std::uint32_t> edges;
+        for (auto& net : data.nets)
+            for (auto tp : net.twopin) {
+                p.route(tp, grid_cost);
+                for (const auto& rp : tp.path) edges.push_back(grid.index(rp.x, rp.y, rp.hori));
+            }
+        for (int sel = 0; sel < 3; sel++) {
+            CostModel cm(sel);
+            double per_edge = best_of_3([&] {
+                for (int pass = 0; pass < passes; pass++)
+                    for (auto e : edges) grid.cost(e) = calc_per_edge(cm, grid.demand(e), grid.cap(e), grid.he(e));
+            });
+            auto expect = grid;
+            double policy = best_of_3([&] {
+                cm.visit([&](const auto& m) {
+                    for (int pass = 0; pass < passes; pass++)
+                        for (auto e : edges) grid.cost(e) = m.edge_cost(grid.demand(e), grid.cap(e), grid.he(e));
+                });
+            });
+            bool same = true;
+            for (auto e : edges) same = same && grid.cost(e) == expect.cost(e);
+            std::printf("%-10s %8d %10zu %10.3f %10.3f %7.2fx%s\n", p.name, sel, edges.size(), per_edge, policy,
+                        per_edge / policy, same ? "" : "  (costs differ!)");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Grid layout benchmark: the same HUM searches and path walks on every edge
+// layout in router/grid_graph.hpp.
+//
+//   make bench
+//   ./bench/grid_layout_bench design.gr [rounds] 2>/dev/null
+//
+// The design is routed through monotonic routing (HUM and refine off) with
+// the build's layout, and its edge state is copied into a grid of each
+// layout. Then, per layout and from the same RNG seed:
+//   hum   `rounds` rounds of hum::HUM over the two-pins left on overflowed
+//         edges; boxes grow every round, as in the HUM phase
+//   walk  ripup/place-style demand updates along every routed path
+// Every layout must produce the same HUM paths. Times are the best of 3.
+//
+// End to end, rebuild with `make clean && make GridLayout=<name>` and time the
+// router itself.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "router/hum.hpp"
+#include "router/ispd_data.hpp"
+#include "router/routing_core.hpp"
+#include "router/snapshot.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/utils.hpp"
+
+using namespace vlsigr;
+
+namespace {
+
+template<typename F>
+double best_of_3(F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, sec_since(start));
+    }
+    return best;
+}
+
+struct Workload {
+    const SoAGridGraph* grid;          // routed state, HUM costs built
+    std::vector<TwoPin> hot;           // two-pins HUM would reroute
+    std::vector<const TwoPin*> all;    // every routed two-pin
+    int rounds;
+    std::vector<RPoint> reference;     // concatenated HUM paths of the first layout
+};
+
+template<typename Layout>
+void run_layout(Workload& w, CostModel& cm) {
+    using Grid = BasicSoAGridGraph<Layout>;
+    const auto& src = *w.grid;
+    Grid grid;
+    grid.init(src.width(), src.height(), Edge(0), Edge(0));
+    for (std::size_t i = 0; i < src.size(); i++) {
+        int x, y;
+        bool hori;
+        src.idx2rp(i, x, y, hori);
+        if (src.contains(x, y, hori)) grid.set_edge(grid.index(x, y, hori), src.edge(i));
+    }
+
+    std::vector<RPoint> paths;
+    double hum = best_of_3([&] {
+        auto tps = w.hot;
+        std::vector<hum::SearchBox> boxes;
+        for (auto& tp : tps) boxes.push_back(hum::SearchBox::around(tp));
+        rng.seed(1);
+        for (int r = 0; r < w.rounds; r++)
+            for (std::size_t i = 0; i < tps.size(); i++)
+                hum::HUM(tps[i], boxes[i], grid, cm, grid.width(), grid.height());
+        paths.clear();
+        for (auto& tp : tps) paths.insert(paths.end(), tp.path.begin(), tp.path.end());
+    });
+    bool same = true;
+    if (w.reference.empty()) {
+        w.reference = paths;
+    } else {
+        same = paths.size() == w.reference.size();
+        for (std::size_t i = 0; same && i < paths.size(); i++)
+            same = paths[i].x == w.reference[i].x && paths[i].y == w.reference[i].y &&
+                   paths[i].hori == w.reference[i].hori;
+    }
+
+    double walk = best_of_3([&] {
+        for (int pass = 0; pass < 10; pass++) {
+            for (auto tp : w.all)
+                for (const auto& rp : tp->path) {
+                    auto e = grid.index(rp.x, rp.y, rp.hori);
+                    if (grid.used(e)++ == 0) grid.demand(e)++;
+                }
+            for (auto tp : w.all)
+                for (const auto& rp : tp->path) {
+                    auto e = grid.index(rp.x, rp.y, rp.hori);
+                    if (--grid.used(e) == 0) grid.demand(e)--;
+                }
+        }
+    });
+
+    std::printf("%-8s %10.1f %10.3f %10.3f %s\n", Layout::name,
+                grid.size() * (sizeof(int) * 5 + sizeof(EdgeCost)) / 1048576.0, hum, walk,
+                same ? "" : "  (HUM paths differ!)");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <design.gr|design.snap> [rounds]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    auto data = is_snapshot_file(path) ? load_snapshot(path) : parse_ispd_file(path);
+
+    RoutingCore core;
+    RoutingCore::Config cfg;
+    cfg.enable_hum = false;
+    cfg.enable_refine = false;
+    core.set_config(cfg);
+    core.route(data, false);
+
+    SoAGridGraph grid = core.grid();
+    CostModel cm(cfg.selcost_hum);
+    cm.build_cost(grid);
+
+    Workload w{&grid, {}, {}, argc > 2 ? std::atoi(argv[2]) : 5, {}};
+    for (auto& net : data.nets)
+        for (auto& tp : net.twopin) {
+            w.all.push_back(&tp);
+            for (const auto& rp : tp.path)
+                if (grid.overflow(grid.index(rp.x, rp.y, rp.hori))) {
+                    w.hot.push_back(tp);
+                    break;
+                }
+        }
+    if (w.hot.empty())
+        for (auto tp : w.all) w.hot.push_back(*tp);
+
+    std::printf("%zux%zu grid, %zu two-pins, %zu on overflowed edges, %d HUM rounds\n",
+                grid.width(), grid.height(), w.all.size(), w.hot.size(), w.rounds);
+    std::printf("%-8s %10s %10s %10s\n", "layout", "grid MiB", "hum s", "walk s");
+    run_layout<WireLayout>(w, cm);
+    run_layout<TiledLayout<8>>(w, cm);
+    run_layout<TiledLayout<16>>(w, cm);
+    run_layout<MortonLayout>(w, cm);
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Pattern routing benchmark: patterns::Lshape, Zshape and Monotonic with
+// edge costs through a std::function cost_fn (an indirect call per edge)
+// versus the SoAGridGraph overloads (costs read inline), then Monotonic
+// versus MonotonicWavefront on the grid.
+//
+//   make bench
+//   ./bench/pattern_inline_bench design.gr [passes] 2>/dev/null
+//
+// The design is routed through monotonic routing (HUM and refine off). Then
+// every two-pin is rerouted `passes` times on the routed costs, both ways
+// from the same RNG seed. Paths must match exactly; MonotonicWavefront's
+// (other tie-breaks) must cost the same. Times are the best of 3.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "router/ispd_data.hpp"
+#include "router/patterns.hpp"
+#include "router/routing_core.hpp"
+#include "router/snapshot.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/utils.hpp"
+
+using namespace vlsigr;
+
+namespace {
+
+template<typename F>
+double best_of_3(F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, sec_since(start));
+    }
+    return best;
+}
+
+bool same_paths(const std::vector<TwoPin>& a, const std::vector<TwoPin>& b) {
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].path.size() != b[i].path.size()) return false;
+        auto it = b[i].path.begin();
+        for (auto rp : a[i].path) {
+            auto q = *it++;
+            if (rp.x != q.x || rp.y != q.y || rp.hori != q.hori) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <design.gr|design.snap> [passes]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    const int passes = argc > 2 ? std::atoi(argv[2]) : 3;
+    auto data = is_snapshot_file(path) ? load_snapshot(path) : parse_ispd_file(path);
+
+    RoutingCore core;
+    RoutingCore::Config cfg;
+    cfg.enable_hum = false;
+    cfg.enable_refine = false;
+    core.set_config(cfg);
+    core.route(data, false);
+    const SoAGridGraph& grid = core.grid();
+
+    std::vector<TwoPin> tps;
+    for (auto& net : data.nets)
+        for (auto& tp : net.twopin) tps.push_back(tp);
+
+    const patterns::CostFn cost_fn = [&](int x, int y, bool hori) { return grid.cost(x, y, hori); };
+    using ByFn = void (*)(TwoPin&, const patterns::CostFn&);
+    using ByGrid = void (*)(TwoPin&, const SoAGridGraph&);
+    const struct {
+        const char* name;
+        ByFn by_fn;
+        ByGrid by_grid;
+    } patterns[] = {{"Lshape", patterns::Lshape, patterns::Lshape},
+                    {"Zshape", patterns::Zshape, patterns::Zshape},
+                    {"Monotonic", patterns::Monotonic, patterns::Monotonic}};
+
+    std::printf("%zux%zu grid, %zu two-pins, %d passes\n", grid.width(), grid.height(), tps.size(), passes);
+    std::printf("%-10s %12s %12s %8s\n", "pattern", "cost_fn s", "grid s", "speedup");
+    for (auto& p : patterns) {
+        auto by_fn = tps, by_grid = tps;
+        double fn_s = best_of_3([&] {
+            rng.seed(1);
+            for (int pass = 0; pass < passes; pass++)
+                for (auto& tp : by_fn) p.by_fn(tp, cost_fn);
+        });
+        double grid_s = best_of_3([&] {
+            rng.seed(1);
+            for (int pass = 0; pass < passes; pass++)
+                for (auto& tp : by_grid) p.by_grid(tp, grid);
+        });
+        std::printf("%-10s %12.3f %12.3f %7.2fx%s\n", p.name, fn_s, grid_s, fn_s / grid_s,
+                    same_paths(by_fn, by_grid) ? "" : "  (paths differ!)");
+    }
+
+    // MonotonicWavefront breaks ties its own way: compare path costs, not paths.
+    auto by_dp = tps, by_wave = tps;
+    double dp_s = best_of_3([&] {
+        rng.seed(1);
+        for (int pass = 0; pass < passes; pass++)
+            for (auto& tp : by_dp) patterns::Monotonic(tp, grid);
+    });
+    double wave_s = best_of_3([&] {
+        for (int pass = 0; pass < passes; pass++)
+            for (auto& tp : by_wave) patterns::MonotonicWavefront(tp, grid);
+    });
+    // Summed from `from` on, in the DP's order, so double costs agree exactly.
+    auto path_cost = [&](const TwoPin& tp) {
+        std::vector<EdgeCost> edges;
+        for (auto rp : tp.path) edges.push_back(grid.cost(rp.x, rp.y, rp.hori));
+        EdgeCost c = 0;
+        for (auto it = edges.rbegin(); it != edges.rend(); ++it) c = cost_add(c, *it);
+        return c;
+    };
+    bool same_cost = true;
+    for (std::size_t i = 0; i < tps.size(); i++) same_cost = same_cost && path_cost(by_dp[i]) == path_cost(by_wave[i]);
+    std::printf("\n%-10s %12s %12s %8s\n", "pattern", "grid s", "wavefront s", "speedup");
+    std::printf("%-10s %12.3f %12.3f %7.2fx%s\n", "Monotonic", dp_s, wave_s, dp_s / wave_s,
+                same_cost ? "" : "  (path costs differ!)");
+
+    // Design two-pins are mostly short; square boxes of growing span at
+    // random places show where the wavefront takes over.
+    const int limit = static_cast<int>(std::min(grid.width(), grid.height())) - 1;
+    for (int span : {16, 64, 128, 256}) {
+        if (span > limit) break;
+        std::vector<TwoPin> boxes(std::max<std::size_t>(8, tps.size() * 16 / (span * span)));
+        rng.seed(7);
+        for (auto& tp : boxes) {
+            int x = randint<int>(0, limit - span), y = randint<int>(0, limit - span);
+            tp.from = Point(x, y + span, 0);
+            tp.to = Point(x + span, y, 0);
+        }
+        auto box_dp = boxes, box_wave = boxes;
+        double span_dp = best_of_3([&] {
+            for (auto& tp : box_dp) patterns::Monotonic(tp, grid);
+        });
+        double span_wave = best_of_3([&] {
+            for (auto& tp : box_wave) patterns::MonotonicWavefront(tp, grid);
+        });
+        bool span_same = true;
+        for (std::size_t i = 0; i < boxes.size(); i++)
+            span_same = span_same && path_cost(box_dp[i]) == path_cost(box_wave[i]);
+        char name[32];
+        std::snprintf(name, sizeof(name), "  span %d", span);
+        std::printf("%-10s %12.3f %12.3f %7.2fx%s\n", name, span_dp, span_wave, span_dp / span_wave,
+                    span_same ? "" : "  (path costs differ!)");
+    }
+    return 0;
+}
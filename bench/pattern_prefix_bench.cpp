@@ -0,0 +1,114 @@
+// Pattern routing benchmark: patterns::Lshape / Zshape over per-edge costs
+// (a cost_fn call per edge, a box DP for Zshape) versus over running cost
+// sums (CostPrefix: range queries per leg, one per Z bend).
+//
+//   make bench
+//   ./bench/pattern_prefix_bench design.gr [two-pins per span] 2>/dev/null
+//
+// The design is routed through monotonic routing (HUM and refine off) for
+// realistic costs. Then two-pins of growing span (bounding box dx = dy) are
+// drawn at random positions, and every pattern routes each of them both ways
+// from the same RNG seed. Paths must match (always with CostType=fixed; with
+// double, rounding can break a near tie differently). Times are the best of 3.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "router/cost_prefix.hpp"
+#include "router/ispd_data.hpp"
+#include "router/patterns.hpp"
+#include "router/routing_core.hpp"
+#include "router/snapshot.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/utils.hpp"
+
+using namespace vlsigr;
+
+namespace {
+
+template<typename F>
+double best_of_3(F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int rep = 0; rep < 3; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, sec_since(start));
+    }
+    return best;
+}
+
+bool same_paths(const std::vector<TwoPin>& a, const std::vector<TwoPin>& b) {
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].path.size() != b[i].path.size()) return false;
+        auto it = b[i].path.begin();
+        for (auto rp : a[i].path) {
+            auto q = *it++;
+            if (rp.x != q.x || rp.y != q.y || rp.hori != q.hori) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <design.gr|design.snap> [two-pins per span]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    const int count = argc > 2 ? std::atoi(argv[2]) : 2000;
+    auto data = is_snapshot_file(path) ? load_snapshot(path) : parse_ispd_file(path);
+
+    RoutingCore core;
+    RoutingCore::Config cfg;
+    cfg.enable_hum = false;
+    cfg.enable_refine = false;
+    core.set_config(cfg);
+    core.route(data, false);
+    const SoAGridGraph& grid = core.grid();
+    CostPrefix prefix;
+    prefix.build(grid);
+
+    auto grid_cost = [&](int x, int y, bool hori) { return grid.cost(x, y, hori); };
+    using ByFn = void (*)(TwoPin&, const patterns::CostFn&);
+    using ByPrefix = void (*)(TwoPin&, const CostPrefix&);
+    const struct {
+        const char* name;
+        ByFn by_fn;
+        ByPrefix by_prefix;
+    } patterns[] = {{"Lshape", patterns::Lshape, patterns::Lshape}, {"Zshape", patterns::Zshape, patterns::Zshape}};
+
+    const int limit = static_cast<int>(std::min(grid.width(), grid.height())) - 1;
+    std::printf("%zux%zu grid, %d two-pins per span\n", grid.width(), grid.height(), count);
+    std::printf("%-8s %6s %12s %12s %8s\n", "pattern", "span", "cost_fn s", "prefix s", "speedup");
+    for (int span : {4, 16, 64, 256}) {
+        if (span > limit) break;
+        rng.seed(7);
+        std::vector<TwoPin> tps(count);
+        for (auto& tp : tps) {
+            int x = randint<int>(0, limit - span), y = randint<int>(0, limit - span);
+            bool flip = randint<int>(0, 1);
+            tp.from = Point(x, flip ? y + span : y, 0);
+            tp.to = Point(x + span, flip ? y : y + span, 0);
+        }
+        for (auto& p : patterns) {
+            auto by_fn = tps, by_prefix = tps;
+            double fn_s = best_of_3([&] {
+                rng.seed(1);
+                for (auto& tp : by_fn) p.by_fn(tp, grid_cost);
+            });
+            double prefix_s = best_of_3([&] {
+                rng.seed(1);
+                for (auto& tp : by_prefix) p.by_prefix(tp, prefix);
+            });
+            std::printf("%-8s %6d %12.4f %12.4f %7.1fx%s\n", p.name, span, fn_s, prefix_s, fn_s / prefix_s,
+                        same_paths(by_fn, by_prefix) ? "" : "  (paths differ)");
+        }
+    }
+    return 0;
+}
@@ -137,6 +137,18 @@ PYBIND11_MODULE(vlsigr, m) {
     py::class_<vlsigr::GlobalRouter>(m, "GlobalRouter")
         .def(py::init<>())
         .def("load_ispd_benchmark", &vlsigr::GlobalRouter::load_ispd_benchmark, py::arg("path"))
+        .def(
+            "load_ispd_bytes",
+            [](vlsigr::GlobalRouter& r, const py::bytes& data) {
+                char* buf = nullptr;
+                Py_ssize_t len = 0;
+                if (PyBytes_AsStringAndSize(data.ptr(), &buf, &len) != 0) throw py::error_already_set();
+                py::gil_scoped_release release;
+                r.load_ispd_buffer(buf, static_cast<std::size_t>(len));
+            },
+            py::arg("data"))
+        .def("load_snapshot", &vlsigr::GlobalRouter::load_snapshot, py::arg("path"))
+        .def("save_snapshot", &vlsigr::GlobalRouter::save_snapshot, py::arg("path"))
         .def("set_mode",
              [](vlsigr::GlobalRouter& r, vlsigr::Mode mode) { r.setMode(mode); },
              py::arg("mode"))
@@ -146,13 +158,39 @@ PYBIND11_MODULE(vlsigr, m) {
         .def("enable_hum_optimization",
              [](vlsigr::GlobalRouter& r, bool on) { r.enableHUMOptimization(on); },
              py::arg("on"))
+        .def("enable_streaming_load",
+             [](vlsigr::GlobalRouter& r, bool on) { r.enableStreamingLoad(on); },
+             py::arg("on"))
+        .def("enable_checkpoints", &vlsigr::GlobalRouter::enableCheckpoints,
+             py::arg("path"), py::arg("interval_sec") = 600.0)
         .def(
             "route",
-            [](vlsigr::GlobalRouter& r, const std::string& output_txt) {
-                r.route(output_txt);
+            [](vlsigr::GlobalRouter& r, const std::string& output_txt, const std::string& result_bin) {
+                r.route(output_txt, result_bin);
+                return snapshot_results(r.data());
+            },
+            py::arg("output_txt") = std::string{},
+            py::arg("result_bin") = std::string{})
+        .def(
+            "resume",
+            [](vlsigr::GlobalRouter& r, const std::string& checkpoint, const std::string& output_txt,
+               const std::string& result_bin) {
+                r.resume(checkpoint, output_txt, result_bin);
+                return snapshot_results(r.data());
+            },
+            py::arg("checkpoint"),
+            py::arg("output_txt") = std::string{},
+            py::arg("result_bin") = std::string{})
+        .def(
+            "route_eco",
+            [](vlsigr::GlobalRouter& r, const std::string& delta_file, const std::string& output_txt,
+               const std::string& result_bin) {
+                r.route_eco_file(delta_file, output_txt, result_bin);
                 return snapshot_results(r.data());
             },
-            py::arg("output_txt") = std::string{})
+            py::arg("delta_file"),
+            py::arg("output_txt") = std::string{},
+            py::arg("result_bin") = std::string{})
         .def(
             "get_results",
             [](const vlsigr::GlobalRouter& r) {
@@ -173,7 +211,8 @@ PYBIND11_MODULE(vlsigr, m) {
                py::object layer_dir,
                py::object stats_path,
                py::object out_map,
-               int scale) {
+               int scale,
+               py::object result_file) {
                 vlsigr::draw::DrawOptions opt;
                 opt.out_ppm = out_ppm;
                 opt.scale = scale <= 0 ? 1 : scale;
@@ -189,7 +228,12 @@ PYBIND11_MODULE(vlsigr, m) {
                 set_opt_str(stats_path, opt.stats_path);
                 set_opt_str(out_map, opt.out_map);
 
-                vlsigr::draw::render_from_data(r.data(), opt);
+                // With a routed-result file (route(result_bin=...)), demand comes
+                // from the mmapped 3D result instead of the in-memory 2D paths.
+                if (!result_file.is_none())
+                    vlsigr::draw::render_from_result(r.data(), result_file.cast<std::string>(), opt);
+                else
+                    vlsigr::draw::render_from_data(r.data(), opt);
             },
             py::arg("results"),
             py::arg("out_ppm"),
@@ -201,7 +245,8 @@ PYBIND11_MODULE(vlsigr, m) {
             py::arg("layer_dir") = py::none(),
             py::arg("stats_path") = py::none(),
             py::arg("out_map") = py::none(),
-            py::arg("scale") = 1)
+            py::arg("scale") = 1,
+            py::arg("result_file") = py::none())
         .def("cleanup", &vlsigr::GlobalRouter::cleanup);
 }
 
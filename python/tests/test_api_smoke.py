@@ -59,6 +59,81 @@ def test_python_api_smoke_complex(tmp_path: Path):
     assert len(results.nets) > 0
 
 
+def test_python_api_load_bytes():
+    import vlsigr
+
+    gr = repo_root() / "examples" / "complex.gr"
+    router = vlsigr.GlobalRouter()
+    router.load_ispd_bytes(gr.read_bytes())
+    results = router.route("")
+    assert len(results.nets) > 0
+
+
+def test_python_api_snapshot_roundtrip(tmp_path: Path):
+    import vlsigr
+
+    gr = repo_root() / "examples" / "complex.gr"
+    snap = tmp_path / "complex.snap"
+    router = vlsigr.GlobalRouter()
+    router.load_ispd_benchmark(str(gr))
+    router.save_snapshot(str(snap))
+    assert snap.exists()
+
+    warm = vlsigr.GlobalRouter()
+    warm.load_snapshot(str(snap))
+    results = warm.route("")
+    assert len(results.nets) > 0
+
+
+def test_python_api_result_file_visualize(tmp_path: Path):
+    import vlsigr
+
+    gr = repo_root() / "examples" / "complex.gr"
+    router = vlsigr.GlobalRouter()
+    router.load_ispd_benchmark(str(gr))
+    result_bin = tmp_path / "complex.vgr"
+    results = router.route(str(tmp_path / "complex_output.txt"), result_bin=str(result_bin))
+    assert result_bin.exists()
+
+    out_ppm = tmp_path / "from_result.ppm"
+    router.visualize_results(results, str(out_ppm), result_file=str(result_bin))
+    with out_ppm.open("r") as f:
+        assert f.readline().strip() == "P3"
+
+
+def test_python_api_checkpoint_resume(tmp_path: Path):
+    import vlsigr
+
+    gr = repo_root() / "examples" / "complex.gr"
+    ckpt = tmp_path / "complex.ckpt"
+    router = vlsigr.GlobalRouter()
+    router.enable_checkpoints(str(ckpt), interval_sec=0)
+    router.load_ispd_benchmark(str(gr))
+    router.route("")
+    assert ckpt.exists()
+
+    warm = vlsigr.GlobalRouter()
+    warm.load_ispd_benchmark(str(gr))
+    results = warm.resume(str(ckpt))
+    assert len(results.nets) > 0
+
+
+def test_python_api_route_eco(tmp_path: Path):
+    import vlsigr
+
+    gr = repo_root() / "examples" / "complex.gr"
+    delta = tmp_path / "delta.txt"
+    delta.write_text("remove n0\nadd eco0 100 2 1\n1 22 1\n22 1 1\n")
+    router = vlsigr.GlobalRouter()
+    router.load_ispd_benchmark(str(gr))
+    before = router.route("")
+    results = router.route_eco(str(delta), str(tmp_path / "eco_output.txt"))
+    names = [n.name for n in results.nets]
+    assert len(names) == len(before.nets)
+    assert "n0" not in names and "eco0" in names
+    assert (tmp_path / "eco_output.txt").exists()
+
+
 def test_python_api_adaptec1_optional(tmp_path: Path):
     # Optional (slow) test: enable explicitly.
     if os.environ.get("VLSIGR_RUN_ADAPTEC1") != "1":
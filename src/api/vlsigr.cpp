@@ -5,20 +5,51 @@
 #include <fstream>
 #include <stdexcept>
 
+#include "router/decomposition.hpp"
 #include "router/routing_core.hpp"
+#include "router/snapshot.hpp"
 #include "router/layer_assignment.hpp"
 #include "router/utils.hpp"
 #include "tools/draw_api.hpp"
 
 namespace vlsigr {
 
+GlobalRouter::GlobalRouter() = default;
+GlobalRouter::~GlobalRouter() = default;
+GlobalRouter::GlobalRouter(GlobalRouter&&) noexcept = default;
+GlobalRouter& GlobalRouter::operator=(GlobalRouter&&) noexcept = default;
+
 void GlobalRouter::load_ispd_benchmark(const std::string& gr_path) {
-    data_ = parse_ispd_file(gr_path);
+    core_.reset();
+    data_ = streaming_load_ ? parse_ispd_file_prepared(gr_path) : parse_ispd_file(gr_path);
+    loaded_ = true;
+    results_.data = &data_;
+}
+
+void GlobalRouter::load_ispd_buffer(const char* data, std::size_t size) {
+    core_.reset();
+    data_ = streaming_load_ ? parse_ispd_buffer_prepared(data, size) : parse_ispd_buffer(data, size);
+    loaded_ = true;
+    results_.data = &data_;
+}
+
+void GlobalRouter::load_snapshot(const std::string& path) {
+    core_.reset();
+    data_ = vlsigr::load_snapshot(path);
     loaded_ = true;
     results_.data = &data_;
 }
 
+void GlobalRouter::save_snapshot(const std::string& path) {
+    if (!loaded_) {
+        throw std::runtime_error("GlobalRouter: benchmark not loaded. Call load_ispd_benchmark() or init() first.");
+    }
+    if (!data_.decomposed) prepare_nets(data_);
+    vlsigr::save_snapshot(data_, path);
+}
+
 void GlobalRouter::init(IspdData data) {
+    core_.reset();
     data_ = std::move(data);
     loaded_ = true;
     results_.data = &data_;
@@ -36,21 +67,59 @@ void GlobalRouter::enableHUMOptimization(bool on) {
     hum_ = on;
 }
 
+void GlobalRouter::enableStreamingLoad(bool on) {
+    streaming_load_ = on;
+}
+
+void GlobalRouter::enableCheckpoints(const std::string& path, double interval_sec) {
+    checkpoint_path_ = path;
+    checkpoint_interval_ = interval_sec;
+}
+
 void GlobalRouter::cleanup() {
     data_ = IspdData{};
+    core_.reset();
     loaded_ = false;
     results_ = RoutingResults{};
     metrics_ = PerformanceMetrics{};
 }
 
-void GlobalRouter::route(const std::string& la_output) {
+void GlobalRouter::route(const std::string& la_output, const std::string& result_bin) {
+    if (!loaded_) {
+        throw std::runtime_error("GlobalRouter: benchmark not loaded. Call load_ispd_benchmark() or init() first.");
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    make_core();
+    try {
+        core_->route(data_, false);
+    } catch (bool /*done*/) {
+        // Converged early, OK.
+    }
+
+    collect_metrics(vlsigr::sec_since(t0), la_output, result_bin);
+}
+
+void GlobalRouter::resume(const std::string& checkpoint, const std::string& la_output,
+                          const std::string& result_bin) {
     if (!loaded_) {
         throw std::runtime_error("GlobalRouter: benchmark not loaded. Call load_ispd_benchmark() or init() first.");
     }
 
     auto t0 = std::chrono::steady_clock::now();
+    make_core();
+    try {
+        core_->resume(data_, checkpoint);
+    } catch (bool /*done*/) {
+        // Converged early, OK.
+    }
 
-    RoutingCore core;
+    collect_metrics(vlsigr::sec_since(t0), la_output, result_bin);
+}
+
+void GlobalRouter::make_core() {
+    core_ = std::make_unique<RoutingCore>();
+    auto& core = *core_;
     // Map API flags to routing core behavior.
     RoutingCore::Config cfg;
     cfg.adaptive_scoring = adaptive_scoring_;
@@ -86,19 +155,37 @@ void GlobalRouter::route(const std::string& la_output) {
             break;
     }
     core.set_config(cfg);
-    try {
-        core.route(data_, false);
-    } catch (bool /*done*/) {
-        // Converged early, OK.
+
+    RoutingCore::CheckpointOptions ckpt;
+    ckpt.path = checkpoint_path_;
+    ckpt.interval_sec = checkpoint_interval_;
+    core.set_checkpoint(std::move(ckpt));
+}
+
+EcoStats GlobalRouter::route_eco(const NetlistDelta& delta, const std::string& la_output,
+                                 const std::string& result_bin) {
+    if (!core_) {
+        throw std::runtime_error("GlobalRouter: no routed design. Call route() before route_eco().");
     }
+    auto t0 = std::chrono::steady_clock::now();
+    auto st = core_->eco(data_, delta);
+    collect_metrics(vlsigr::sec_since(t0), la_output, result_bin);
+    return st;
+}
+
+EcoStats GlobalRouter::route_eco_file(const std::string& delta_path, const std::string& la_output,
+                                      const std::string& result_bin) {
+    return route_eco(parse_netlist_delta_file(delta_path), la_output, result_bin);
+}
 
+void GlobalRouter::collect_metrics(double runtime_sec, const std::string& la_output, const std::string& result_bin) {
     metrics_ = PerformanceMetrics{};
-    metrics_.runtime_sec = vlsigr::sec_since(t0);
+    metrics_.runtime_sec = runtime_sec;
     results_.data = &data_;
 
     // If requested, run LayerAssignment and use its statistics (best available metrics).
-    if (!la_output.empty()) {
-        auto la = run_layer_assignment(data_, la_output, true);
+    if (!la_output.empty() || !result_bin.empty()) {
+        auto la = run_layer_assignment(data_, la_output, true, result_bin);
         metrics_.total_overflow = la.totalOF;
         metrics_.max_overflow = la.maxOF;
         metrics_.total_vias = la.totalVia;
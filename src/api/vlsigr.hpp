@@ -1,13 +1,18 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "router/eco.hpp"
 #include "router/ispd_data.hpp"
 
 namespace vlsigr {
 
+class RoutingCore;
+
 enum class Mode : std::uint8_t {
     BALANCED = 0,
     CONGESTION = 1,
@@ -29,16 +34,49 @@ struct PerformanceMetrics {
 
 class GlobalRouter {
 public:
-    GlobalRouter() = default;
+    GlobalRouter();
+    ~GlobalRouter();
+    GlobalRouter(GlobalRouter&&) noexcept;
+    GlobalRouter& operator=(GlobalRouter&&) noexcept;
 
     void load_ispd_benchmark(const std::string& gr_path);
+    // Parse a benchmark already held in memory (e.g. Python bytes); the buffer is not retained.
+    void load_ispd_buffer(const char* data, std::size_t size);
+
+    // Binary design snapshots (see router/snapshot.hpp). Loading a decomposed
+    // snapshot skips parsing, pin projection and net decomposition entirely.
+    void load_snapshot(const std::string& path);
+    // Prepares (projects + decomposes) the loaded design first if needed.
+    void save_snapshot(const std::string& path);
 
     void init(IspdData data);
     void setMode(Mode m);
     void enableAdaptiveScoring(bool on);
     void enableHUMOptimization(bool on);
-
-    void route(const std::string& la_output = "");
+    // Project and decompose nets on worker threads while the file is still being
+    // parsed (applies to later load_ispd_benchmark/load_ispd_buffer calls).
+    void enableStreamingLoad(bool on);
+    // Checkpoint the routing state to `path` during route()/resume(), at most
+    // every interval_sec seconds (see router/checkpoint.hpp); empty path disables.
+    void enableCheckpoints(const std::string& path, double interval_sec = 600.0);
+
+    // Non-empty la_output / result_bin run layer assignment and write the text
+    // output.txt and/or the binary routed-result file (router/result_file.hpp).
+    void route(const std::string& la_output = "", const std::string& result_bin = "");
+
+    // Continue an interrupted route() of the loaded design from a checkpoint;
+    // the result is identical to an uninterrupted run. Outputs as in route().
+    void resume(const std::string& checkpoint, const std::string& la_output = "",
+                const std::string& result_bin = "");
+
+    // Incremental reroute (ECO) after a netlist change to the design routed by
+    // the last route(): only the changed nets, and nets they push into
+    // overflow, are ripped up and rerouted; grid demand and congestion history
+    // carry over. Outputs as in route(). A moved router must route() again.
+    EcoStats route_eco(const NetlistDelta& delta, const std::string& la_output = "",
+                       const std::string& result_bin = "");
+    EcoStats route_eco_file(const std::string& delta_path, const std::string& la_output = "",
+                            const std::string& result_bin = "");
 
     const RoutingResults& getResults() const { return results_; }
     const PerformanceMetrics& getPerformanceMetrics() const { return metrics_; }
@@ -55,9 +93,18 @@ private:
     Mode mode_ = Mode::BALANCED;
     bool adaptive_scoring_ = true;
     bool hum_ = true;
+    bool streaming_load_ = false;
+    std::string checkpoint_path_;
+    double checkpoint_interval_ = 600.0;
+
+    // Routing state of the last route(), kept for route_eco().
+    std::unique_ptr<RoutingCore> core_;
 
     RoutingResults results_{};
     PerformanceMetrics metrics_{};
+
+    void make_core();
+    void collect_metrics(double runtime_sec, const std::string& la_output, const std::string& result_bin);
 };
 
 PerformanceMetrics route_ispd_file(const std::string& gr_path, const std::string& la_output = "");
@@ -1,49 +1,134 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <chrono>
 
+#include "router/decomposition.hpp"
+#include "router/eco.hpp"
 #include "router/ispd_data.hpp"
 #include "router/routing_core.hpp"
 #include "router/layer_assignment.hpp"
+#include "router/snapshot.hpp"
 #include "router/utils.hpp"
 
+static void usage(const char* prog) {
+    std::fprintf(stderr, "Usage: %s <input.gr|input.snap> [output.txt] [--save-snapshot design.snap] [--stream]"
+                 " [--result-bin result.vgr] [--eco delta.txt]...\n"
+                 "       [--checkpoint state.ckpt] [--checkpoint-every SEC] [--resume state.ckpt]\n", prog);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::fprintf(stderr, "Usage: %s <input.gr> [output.txt]\n", argv[0]);
+    std::string input_file, output_file, snapshot_out, result_bin;
+    std::string checkpoint, resume_from;
+    double checkpoint_every = 600.0;
+    std::vector<std::string> eco_files;
+    bool stream = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--save-snapshot" && i + 1 < argc) {
+            snapshot_out = argv[++i];
+        } else if (arg == "--result-bin" && i + 1 < argc) {
+            result_bin = argv[++i];
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpoint = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            checkpoint_every = std::atof(argv[++i]);
+        } else if (arg == "--resume" && i + 1 < argc) {
+            resume_from = argv[++i];
+        } else if (arg == "--eco" && i + 1 < argc) {
+            eco_files.push_back(argv[++i]);
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown or incomplete option: %s\n", arg.c_str());
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (input_file.empty()) {
+            input_file = arg;
+        } else if (output_file.empty()) {
+            output_file = arg;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (input_file.empty()) {
+        usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    std::string input_file = argv[1];
-    std::string output_file = (argc >= 3) ? argv[2] : "";
-    
     vlsigr::IspdData data;
     try {
-        data = vlsigr::parse_ispd_file(input_file);
-        std::cerr << "[INFO] Parsed input '" << input_file << "'" << std::endl;
+        auto parse_start = std::chrono::steady_clock::now();
+        if (vlsigr::is_snapshot_file(input_file)) {
+            data = vlsigr::load_snapshot(input_file);
+            std::cerr << "[INFO] Loaded snapshot '" << input_file << "'";
+        } else {
+            data = stream ? vlsigr::parse_ispd_file_prepared(input_file)
+                          : vlsigr::parse_ispd_file(input_file);
+            std::cerr << "[INFO] Parsed input '" << input_file << "'";
+        }
+        std::cerr << " in " << vlsigr::sec_since(parse_start) << "s" << std::endl;
     } catch (const std::runtime_error& e) {
         std::cerr << "[ERROR] Parse failed: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
+
+    if (!snapshot_out.empty()) {
+        try {
+            if (!data.decomposed) vlsigr::prepare_nets(data);
+            vlsigr::save_snapshot(data, snapshot_out);
+            std::cerr << "[INFO] Snapshot written to '" << snapshot_out << "'" << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[ERROR] Snapshot failed: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
     
     vlsigr::RoutingCore router;
+    if (!checkpoint.empty()) {
+        vlsigr::RoutingCore::CheckpointOptions ckpt;
+        ckpt.path = checkpoint;
+        ckpt.interval_sec = checkpoint_every;
+        router.set_checkpoint(std::move(ckpt));
+    }
     std::cerr << "[*] parsing done, start routing..." << std::endl;
     
     try {
-        router.route(data, false);
+        if (resume_from.empty()) {
+            router.route(data, false);
+        } else {
+            std::cerr << "[INFO] Resuming from checkpoint '" << resume_from << "'" << std::endl;
+            router.resume(data, resume_from);
+        }
     } catch (bool done) {
         if (done) {
             std::cerr << "[INFO] Routing converged to 0 overflow!" << std::endl;
         }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[ERROR] Routing failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
     } catch (...) {
         std::cerr << "[ERROR] Routing failed" << std::endl;
         return EXIT_FAILURE;
     }
     
     std::cerr << "[INFO] Routing completed" << std::endl;
+
+    // Each delta is applied to the result of the previous one.
+    for (auto& eco_file : eco_files) {
+        try {
+            auto st = router.eco(data, vlsigr::parse_netlist_delta_file(eco_file));
+            std::cerr << "[INFO] ECO '" << eco_file << "' done, overflow " << st.overflow << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[ERROR] ECO failed: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
     
-    if (!output_file.empty()) {
+    if (!output_file.empty() || !result_bin.empty()) {
         // Debug: check path state before LA
         std::cerr << "[DEBUG] Before LA: checking paths" << std::endl;
         for (std::size_t i = 0; i < std::min(data.nets.size(), (std::size_t)3); ++i) {
@@ -56,9 +141,18 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        std::cerr << "[*] Starting Layer Assignment -> " << output_file << std::endl;
+        std::cerr << "[*] Starting Layer Assignment ->";
+        if (!output_file.empty()) std::cerr << " " << output_file;
+        if (!result_bin.empty()) std::cerr << " " << result_bin;
+        std::cerr << std::endl;
         auto la_start = std::chrono::steady_clock::now();
-        auto res = vlsigr::run_layer_assignment(data, output_file, true);
+        vlsigr::LayerAssignmentResult res;
+        try {
+            res = vlsigr::run_layer_assignment(data, output_file, true, result_bin);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[ERROR] Layer assignment output failed: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
         std::cerr << "[INFO] LA done in " << vlsigr::sec_since(la_start) << "s"
                   << " totalOF=" << res.totalOF
                   << " maxOF=" << res.maxOF
@@ -0,0 +1,126 @@
+#pragma once
+
+// Little helpers for the native-endian binary files written by the router
+// (design snapshots, checkpoints). Writers buffer everything and emit it with
+// one fwrite; readers decode from a single in-memory view with bounds checks.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace vlsigr {
+
+class BinaryWriter {
+public:
+    template<typename T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>, "put() needs a trivially copyable type");
+        auto p = reinterpret_cast<const char*>(&v);
+        buf_.insert(buf_.end(), p, p + sizeof(T));
+    }
+
+    template<typename T>
+    void put_array(const T* v, std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>, "put_array() needs a trivially copyable type");
+        auto p = reinterpret_cast<const char*>(v);
+        buf_.insert(buf_.end(), p, p + n * sizeof(T));
+    }
+
+    template<typename T>
+    void put_vector(const std::vector<T>& v) {
+        put<std::uint64_t>(v.size());
+        put_array(v.data(), v.size());
+    }
+
+    void put_string(const std::string& s) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+        buf_.insert(buf_.end(), s.begin(), s.end());
+    }
+
+    void reserve(std::size_t n) { buf_.reserve(n); }
+    const std::vector<char>& bytes() const { return buf_; }
+
+    // Throws std::runtime_error on I/O failure.
+    void write_file(const std::string& path) const {
+        FILE* fp = std::fopen(path.c_str(), "wb");
+        if (!fp) throw std::runtime_error("failed to open file for writing: " + path);
+        bool ok = std::fwrite(buf_.data(), 1, buf_.size(), fp) == buf_.size();
+        ok = (std::fclose(fp) == 0) && ok;
+        if (!ok) throw std::runtime_error("failed to write file: " + path);
+    }
+
+private:
+    std::vector<char> buf_;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char* data, std::size_t size, const char* what = "binary file")
+        : p_(data), end_(data + size), what_(what) {}
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>, "get() needs a trivially copyable type");
+        T v;
+        need(sizeof(T));
+        std::memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return v;
+    }
+
+    template<typename T>
+    void get_array(T* out, std::size_t n) {
+        need_items(n, sizeof(T));
+        std::memcpy(out, p_, n * sizeof(T));
+        p_ += n * sizeof(T);
+    }
+
+    template<typename T>
+    void get_vector(std::vector<T>& out) {
+        auto n = get_count<std::uint64_t>(sizeof(T));
+        out.resize(n);
+        get_array(out.data(), out.size());
+    }
+
+    // Read an element count of type Count, checked against the data left for
+    // elements of at least min_bytes each, before anything is sized by it.
+    template<typename Count>
+    std::size_t get_count(std::size_t min_bytes) {
+        auto n = get<Count>();
+        need_items(n, min_bytes);
+        return static_cast<std::size_t>(n);
+    }
+
+    std::string get_string() {
+        auto n = get<std::uint32_t>();
+        need(n);
+        std::string s(p_, p_ + n);
+        p_ += n;
+        return s;
+    }
+
+    bool at_end() const { return p_ == end_; }
+
+private:
+    const char* p_;
+    const char* end_;
+    const char* what_;
+
+    void need(std::size_t n) const {
+        if (static_cast<std::size_t>(end_ - p_) < n) truncated();
+    }
+    // n items of size bytes each, without overflowing n * size.
+    void need_items(std::uint64_t n, std::size_t size) const {
+        if (n > static_cast<std::size_t>(end_ - p_) / size) truncated();
+    }
+    [[noreturn]] void truncated() const {
+        throw std::runtime_error(std::string(what_) + ": unexpected end of data");
+    }
+};
+
+}  // namespace vlsigr
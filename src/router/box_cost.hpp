@@ -0,0 +1,123 @@
+#pragma once
+
+// Cost grid for the box searches (pattern routing, HUM): per cell the best
+// path cost so far, in 2 bits the neighbour it came through, and a bit for
+// whether it has one (fixed-point path costs saturate, so kCostInf does not
+// mean unreached). Cells live in a BoxScratch the caller keeps (one per box it
+// holds at once, per thread) and reuses, so a search allocates nothing once
+// the scratch has grown to its largest box.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "router/edge_cost.hpp"
+#include "router/ispd_data.hpp"
+#include "router/segment_path.hpp"
+
+namespace vlsigr {
+
+// Backing storage for one BoxCost at a time; only grows.
+struct BoxScratch {
+    std::vector<EdgeCost> cost;
+    std::vector<std::uint8_t> from;     // 4 cells per byte
+    std::vector<std::uint8_t> reached;  // 8 cells per byte
+};
+
+class BoxCost {
+public:
+    // Neighbour a cell was reached from.
+    enum From : std::uint8_t { kLeft, kRight, kDown, kUp };
+    // Cell order: column by column (a column's cells are adjacent) or row by row.
+    enum Order : std::uint8_t { kByColumn, kByRow };
+
+    // Box [L, R] x [B, U] over scratch, every cell at kCostInf and unreached.
+    BoxCost(int L, int R, int B, int U, BoxScratch& scratch, Order order = kByColumn)
+        : L_(L), B_(B),
+          sx_(order == kByColumn ? static_cast<std::size_t>(U - B + 1) : 1),
+          sy_(order == kByColumn ? 1 : static_cast<std::size_t>(R - L + 1)),
+          n_(static_cast<std::size_t>(R - L + 1) * static_cast<std::size_t>(U - B + 1)) {
+        if (scratch.cost.size() < n_) scratch.cost.resize(n_);
+        if (scratch.from.size() < (n_ + 3) / 4) scratch.from.resize((n_ + 3) / 4);
+        if (scratch.reached.size() < (n_ + 7) / 8) scratch.reached.resize((n_ + 7) / 8);
+        std::fill_n(scratch.cost.begin(), n_, kCostInf);
+        std::fill_n(scratch.reached.begin(), (n_ + 7) / 8, 0);
+        cost_ = scratch.cost.data();
+        from_ = scratch.from.data();
+        reached_ = scratch.reached.data();
+    }
+
+    EdgeCost& cost(int x, int y) { return cost_[at(x, y)]; }
+    EdgeCost cost(int x, int y) const { return cost_[at(x, y)]; }
+
+    // Whether (x, y) has a predecessor; from() is meaningful only then.
+    bool reached(int x, int y) const {
+        auto i = at(x, y);
+        return (reached_[i >> 3] >> (i & 7)) & 1;
+    }
+    From from(int x, int y) const {
+        auto i = at(x, y);
+        return static_cast<From>((from_[i >> 2] >> ((i & 3) * 2)) & 3);
+    }
+    void set_from(int x, int y, From d) {
+        auto i = at(x, y);
+        auto shift = (i & 3) * 2;
+        from_[i >> 2] = static_cast<std::uint8_t>((from_[i >> 2] & ~(3u << shift)) | (unsigned(d) << shift));
+        reached_[i >> 3] = static_cast<std::uint8_t>(reached_[i >> 3] | (1u << (i & 7)));
+    }
+    // Reach (x, y) at cost c through its d neighbour.
+    void reach(int x, int y, EdgeCost c, From d) {
+        cost(x, y) = c;
+        set_from(x, y, d);
+    }
+
+    // Raw cell access for line kernels (min_plus.hpp): cell (x, y) is
+    // cost_data()[index(x, y)], and neighbours along a column (kByColumn) or
+    // row (kByRow) are adjacent.
+    std::size_t index(int x, int y) const { return at(x, y); }
+    EdgeCost* cost_data() { return cost_; }
+    // set_from(d) on cells i + l, l < 8, for each bit l set in mask.
+    void set_from8(std::size_t i, unsigned mask, From d) {
+        std::uint32_t m = mask & 0xFF;  // spread bit l to bits 2l and 2l + 1
+        m = (m | (m << 4)) & 0x0F0F;
+        m = (m | (m << 2)) & 0x3333;
+        m = (m | (m << 1)) & 0x5555;
+        m |= m << 1;
+        write_bits(from_ + (i >> 2), m << ((i & 3) * 2), (0x5555u * d & m) << ((i & 3) * 2));
+        write_bits(reached_ + (i >> 3), (mask & 0xFFu) << (i & 7), (mask & 0xFFu) << (i & 7));
+    }
+
+    // Append the edges from p back to source, following from(). Stops early at
+    // a cell without a predecessor, or after one edge per cell.
+    void trace(SegmentPath& path, Point p, Point source) const {
+        for (std::size_t steps = 0; (p.x != source.x || p.y != source.y) && steps < n_; steps++) {
+            if (!reached(p.x, p.y)) break;
+            switch (from(p.x, p.y)) {
+            case kLeft: path.emplace_back(--p.x, p.y, true); break;
+            case kRight: path.emplace_back(p.x++, p.y, true); break;
+            case kDown: path.emplace_back(p.x, --p.y, false); break;
+            case kUp: path.emplace_back(p.x, p.y++, false); break;
+            }
+        }
+    }
+
+private:
+    int L_, B_;
+    std::size_t sx_, sy_, n_;
+    EdgeCost* cost_;
+    std::uint8_t* from_;
+    std::uint8_t* reached_;
+
+    std::size_t at(int x, int y) const {
+        return static_cast<std::size_t>(x - L_) * sx_ + static_cast<std::size_t>(y - B_) * sy_;
+    }
+
+    // Replace the bits of p[0], p[1], ... selected by mask (byte 0 lowest) with val's.
+    static void write_bits(std::uint8_t* p, std::uint32_t mask, std::uint32_t val) {
+        for (; mask; p++, mask >>= 8, val >>= 8)
+            *p = static_cast<std::uint8_t>((*p & ~mask) | (val & mask));
+    }
+};
+
+}  // namespace vlsigr
@@ -0,0 +1,244 @@
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "router/binary_io.hpp"
+#include "router/hum.hpp"
+#include "router/mapped_file.hpp"
+#include "router/routing_core.hpp"
+#include "router/utils.hpp"
+
+namespace vlsigr {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'L', 'G', 'R', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t kVersion = 4;  // 2: wire-major edge numbering, 3: paths as runs, 4: a box per two-pin
+
+constexpr std::uint8_t kOverflow = 1u << 0;
+constexpr std::uint8_t kRipup = 1u << 1;
+
+void put_box(BinaryWriter& w, const hum::SearchBox& b) {
+    for (int v : {b.L, b.R, b.B, b.U}) w.put<std::int32_t>(v);
+    w.put<std::uint8_t>((b.eL ? 1 : 0) | (b.eR ? 2 : 0) | (b.eB ? 4 : 0) | (b.eU ? 8 : 0));
+}
+
+hum::SearchBox get_box(BinaryReader& r) {
+    hum::SearchBox b;
+    b.L = r.get<std::int32_t>();
+    b.R = r.get<std::int32_t>();
+    b.B = r.get<std::int32_t>();
+    b.U = r.get<std::int32_t>();
+    auto e = r.get<std::uint8_t>();
+    b.eL = (e & 1) != 0;
+    b.eR = (e & 2) != 0;
+    b.eB = (e & 4) != 0;
+    b.eU = (e & 8) != 0;
+    return b;
+}
+
+static_assert(std::is_trivially_copyable_v<RoutingCore::Config>, "Config is stored verbatim");
+static_assert(std::is_trivially_copyable_v<Edge>, "edges are stored verbatim");
+static_assert(std::is_trivially_copyable_v<PathSegment>, "path runs are stored verbatim");
+
+// FNV-1a over the grid size and layout and the two-pin decomposition, to
+// reject a checkpoint taken on a different design or by a build with another
+// grid layout (edges are stored by index).
+std::uint64_t fingerprint(const IspdData& data) {
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](std::int64_t v) {
+        for (int i = 0; i < 8; i++, v >>= 8) {
+            h ^= static_cast<std::uint64_t>(v & 0xff);
+            h *= 1099511628211ull;
+        }
+    };
+    mix(data.numXGrid);
+    mix(data.numYGrid);
+    for (const char* c = GridLayout::name; *c; c++) mix(*c);
+    for (const char* c = kEdgeCostName; *c; c++) mix(*c);
+    mix(static_cast<std::int64_t>(data.nets.size()));
+    for (auto& net : data.nets) {
+        mix(static_cast<std::int64_t>(net.twopin.size()));
+        for (auto& tp : net.twopin) {
+            mix(tp.from.x);
+            mix(tp.from.y);
+            mix(tp.to.x);
+            mix(tp.to.y);
+        }
+    }
+    return h;
+}
+
+// Check that idx is a permutation of [0, n).
+bool is_permutation_of(const std::vector<std::uint32_t>& idx, std::size_t n) {
+    if (idx.size() != n) return false;
+    std::vector<char> seen(n, 0);
+    for (auto i : idx) {
+        if (i >= n || seen[i]) return false;
+        seen[i] = 1;
+    }
+    return true;
+}
+
+}  // namespace
+
+void RoutingCore::write_checkpoint(const std::string& path, const Progress& at) const {
+    const auto& data = *ispdData_;
+    BinaryWriter w;
+    w.put_array(kMagic, sizeof(kMagic));
+    w.put<std::uint32_t>(kVersion);
+    w.put<std::uint64_t>(fingerprint(data));
+    w.put(cfg_);
+    w.put<std::int32_t>(static_cast<std::int32_t>(at.phase));
+    w.put<std::int32_t>(at.iteration);
+    w.put<std::int32_t>(at.prev_of);
+    w.put<std::int32_t>(at.stall);
+
+    std::ostringstream rng_state;
+    rng_state << rng;
+    w.put_string(rng_state.str());
+
+    std::vector<Edge> edges;
+    edges.reserve(grid_.size());
+    for (std::size_t i = 0; i < grid_.size(); i++) edges.push_back(grid_.edge(i));
+    w.put_vector(edges);
+
+    // Visiting order (sort_twopins is not stable, so it carries state) and per-net stats.
+    const Net* base = data.nets.data();
+    w.put<std::uint64_t>(nets_.size());
+    std::vector<std::uint32_t> order;
+    for (auto net : nets_) {
+        w.put<std::uint32_t>(static_cast<std::uint32_t>(net->net - base));
+        for (int v : {net->overflow, net->overflow_twopin, net->wlen, net->reroute})
+            w.put<std::int32_t>(v);
+        w.put<double>(net->score);
+        w.put<double>(net->cost);
+        order.clear();
+        for (auto twopin : net->twopins)
+            order.push_back(static_cast<std::uint32_t>(twopin - net->net->twopin.data()));
+        w.put_vector(order);
+    }
+
+    // Two-pin state in design order; 2D paths are stored as their runs.
+    for (auto& net : data.nets) {
+        for (auto& tp : net.twopin) {
+            w.put<std::int32_t>(tp.reroute);
+            w.put<std::uint8_t>((tp.overflow ? kOverflow : 0) | (tp.ripup ? kRipup : 0));
+            put_box(w, boxes_[tp.id]);
+            w.put_vector(tp.path.segments());
+        }
+    }
+    w.write_file(path);
+}
+
+void RoutingCore::read_checkpoint(const std::string& path) {
+    auto& data = *ispdData_;
+    MappedFile file(path);
+    BinaryReader r(file.data(), file.size(), "checkpoint");
+    auto fail = [&](const std::string& why) { return std::runtime_error("checkpoint: " + why + ": " + path); };
+
+    char magic[sizeof(kMagic)];
+    r.get_array(magic, sizeof(magic));
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) throw fail("bad magic");
+    auto version = r.get<std::uint32_t>();
+    if (version != kVersion) throw fail("unsupported version " + std::to_string(version));
+    if (r.get<std::uint64_t>() != fingerprint(data)) throw fail("taken on a different design or grid layout");
+
+    // Config is stored verbatim: check its bool bytes before reading them as bools.
+    unsigned char config[sizeof(Config)];
+    r.get_array(config, sizeof(config));
+    for (auto at : {offsetof(Config, adaptive_scoring), offsetof(Config, enable_hum), offsetof(Config, enable_refine)})
+        if (config[at] > 1) throw fail("corrupt config");
+    std::memcpy(&cfg_, config, sizeof(cfg_));
+    auto phase = r.get<std::int32_t>();
+    if (phase < static_cast<int>(Phase::Lshape) || phase > static_cast<int>(Phase::RefineLshape))
+        throw fail("corrupt phase");
+    resume_.phase = static_cast<Phase>(phase);
+    resume_.iteration = r.get<std::int32_t>();
+    resume_.prev_of = r.get<std::int32_t>();
+    resume_.stall = r.get<std::int32_t>();
+    if (resume_.iteration < 1 || resume_.prev_of < 0 || resume_.stall < 0) throw fail("corrupt iteration state");
+
+    std::istringstream rng_state(r.get_string());
+    rng_state >> rng;
+    if (!rng_state) throw fail("corrupt RNG state");
+
+    std::vector<Edge> edges;
+    r.get_vector(edges);
+    if (edges.size() != grid_.size()) throw fail("grid size mismatch");
+    for (std::size_t i = 0; i < edges.size(); i++) grid_.set_edge(i, edges[i]);
+
+    // nets_ is in design order after setup(); rebuild the saved order from it.
+    auto count = r.get<std::uint64_t>();
+    if (count != nets_.size()) throw fail("net count mismatch");
+    std::vector<NetWrapper*> ordered;
+    std::vector<std::uint32_t> net_order, order;
+    ordered.reserve(nets_.size());
+    for (std::size_t i = 0; i < nets_.size(); i++) {
+        auto idx = r.get<std::uint32_t>();
+        if (idx >= nets_.size()) throw fail("corrupt net order");
+        net_order.push_back(idx);
+        auto net = nets_[idx];
+        net->overflow = r.get<std::int32_t>();
+        net->overflow_twopin = r.get<std::int32_t>();
+        net->wlen = r.get<std::int32_t>();
+        net->reroute = r.get<std::int32_t>();
+        net->score = r.get<double>();
+        net->cost = r.get<double>();
+        r.get_vector(order);
+        if (!is_permutation_of(order, net->twopins.size())) throw fail("corrupt two-pin order");
+        for (std::size_t j = 0; j < order.size(); j++) net->twopins[j] = &net->net->twopin[order[j]];
+        ordered.push_back(net);
+    }
+    if (!is_permutation_of(net_order, nets_.size())) throw fail("corrupt net order");
+    nets_ = std::move(ordered);
+
+    std::vector<PathSegment> runs;
+    for (auto& net : data.nets) {
+        for (auto& tp : net.twopin) {
+            tp.reroute = r.get<std::int32_t>();
+            auto flags = r.get<std::uint8_t>();
+            tp.overflow = (flags & kOverflow) != 0;
+            tp.ripup = (flags & kRipup) != 0;
+            auto box = get_box(r);
+            bool inside = 0 <= box.L && box.L <= std::min(tp.from.x, tp.to.x) &&
+                          std::max(tp.from.x, tp.to.x) <= box.R && box.R < static_cast<int>(grid_.width()) &&
+                          0 <= box.B && box.B <= std::min(tp.from.y, tp.to.y) &&
+                          std::max(tp.from.y, tp.to.y) <= box.U && box.U < static_cast<int>(grid_.height());
+            if (!inside) throw fail("corrupt search box");  // HUM indexes its box unchecked
+            boxes_[tp.id] = box;
+            r.get_vector(runs);
+            tp.path.clear();
+            for (auto& s : runs) {
+                auto n = s.hori ? grid_.width() : grid_.height();
+                bool inside = s.len != 0 && s.len < n && grid_.contains(s.x, s.y, s.hori) &&
+                              (s.hori ? grid_.contains(s.last(), s.y, true) : grid_.contains(s.x, s.last(), false));
+                if (!inside) throw fail("corrupt path");
+                tp.path.append_run(s);
+            }
+        }
+    }
+    if (!r.at_end()) throw fail("trailing data");
+    for (auto net : nets_) collect_net_edges(net);
+    reset_edge_tracking();
+    resuming_ = true;
+}
+
+bool is_checkpoint_file(const std::string& path) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    char magic[sizeof(kMagic)];
+    bool ok = std::fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+              std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    std::fclose(fp);
+    return ok;
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,20 @@
+#pragma once
+
+// Binary checkpoints of an in-progress RoutingCore::route() (see
+// RoutingCore::CheckpointOptions and RoutingCore::resume). A checkpoint holds
+// everything the remaining iterations depend on: the routing Config, the
+// phase/iteration reached, the RNG state, every grid edge (demand, he, of,
+// used, cost), the net and two-pin visiting order with per-net statistics,
+// and each two-pin's path (as straight runs), reroute count, flags and HUM
+// search box.
+// Pins and the decomposition are not stored: resume() re-prepares the design
+// and checks a fingerprint of it. Native-endian, like design snapshots.
+
+#include <string>
+
+namespace vlsigr {
+
+// True if path starts with the checkpoint magic.
+bool is_checkpoint_file(const std::string& path);
+
+}  // namespace vlsigr
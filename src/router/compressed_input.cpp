@@ -0,0 +1,245 @@
+#include "compressed_input.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef VLSIGR_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef VLSIGR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace vlsigr {
+
+namespace {
+
+constexpr unsigned char kGzipMagic[2] = {0x1f, 0x8b};
+constexpr unsigned char kZstdMagic[4] = {0x28, 0xb5, 0x2f, 0xfd};
+
+bool has_magic(const char* data, std::size_t size, const unsigned char* magic, std::size_t n) {
+    return size >= n && std::memcmp(data, magic, n) == 0;
+}
+
+// Fills `out` completely unless the stream ends; returns 0 once exhausted.
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+    virtual std::size_t read(char* out, std::size_t cap) = 0;
+};
+
+#ifdef VLSIGR_HAVE_ZLIB
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder(const char* data, std::size_t size): data_(data), size_(size) {
+        std::memset(&zs_, 0, sizeof(zs_));
+        // 15 + 32: max window, accept gzip or zlib headers.
+        if (inflateInit2(&zs_, 15 + 32) != Z_OK) throw std::runtime_error("gzip: inflateInit failed");
+    }
+    ~GzipDecoder() override { inflateEnd(&zs_); }
+
+    std::size_t read(char* out, std::size_t cap) override {
+        std::size_t produced = 0;
+        while (produced < cap && !finished_) {
+            if (zs_.avail_in == 0) {
+                if (fed_ == size_) throw std::runtime_error("gzip: unexpected end of compressed data");
+                feed();
+            }
+            auto room = static_cast<uInt>(std::min<std::size_t>(cap - produced, UINT_MAX));
+            zs_.next_out = reinterpret_cast<Bytef*>(out + produced);
+            zs_.avail_out = room;
+            int r = inflate(&zs_, Z_NO_FLUSH);
+            produced += room - zs_.avail_out;
+            if (r == Z_STREAM_END) {
+                // Concatenated members (e.g. `cat a.gz b.gz`) decode as one stream;
+                // anything else after the last member is ignored, as gzip does.
+                auto next = reinterpret_cast<const char*>(zs_.next_in);
+                if (has_magic(next, zs_.avail_in, kGzipMagic, sizeof(kGzipMagic)))
+                    inflateReset(&zs_);
+                else
+                    finished_ = true;
+            } else if (r != Z_OK && r != Z_BUF_ERROR) {
+                throw std::runtime_error(std::string("gzip: ") + (zs_.msg ? zs_.msg : "corrupt input"));
+            }
+        }
+        return produced;
+    }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t fed_ = 0;
+    bool finished_ = false;
+    z_stream zs_;
+
+    void feed() {
+        auto n = std::min<std::size_t>(size_ - fed_, UINT_MAX);
+        zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data_ + fed_));
+        zs_.avail_in = static_cast<uInt>(n);
+        fed_ += n;
+    }
+};
+#endif
+
+#ifdef VLSIGR_HAVE_ZSTD
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder(const char* data, std::size_t size): in_{data, size, 0} {
+        ds_ = ZSTD_createDStream();
+        if (!ds_) throw std::runtime_error("zstd: failed to create decoder");
+        ZSTD_initDStream(ds_);
+    }
+    ~ZstdDecoder() override { ZSTD_freeDStream(ds_); }
+
+    std::size_t read(char* out, std::size_t cap) override {
+        if (finished_) return 0;
+        ZSTD_outBuffer ob{out, cap, 0};
+        while (ob.pos < ob.size) {
+            std::size_t r = ZSTD_decompressStream(ds_, &ob, &in_);
+            if (ZSTD_isError(r)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(r));
+            // Output not full and input consumed: everything decodable has been flushed.
+            if (ob.pos < ob.size && in_.pos == in_.size) {
+                if (r != 0) throw std::runtime_error("zstd: unexpected end of compressed data");
+                finished_ = true;
+                break;
+            }
+        }
+        return ob.pos;
+    }
+
+private:
+    ZSTD_DStream* ds_ = nullptr;
+    ZSTD_inBuffer in_;
+    bool finished_ = false;
+};
+#endif
+
+std::unique_ptr<Decoder> make_decoder(Compression c, const char* data, std::size_t size) {
+    switch (c) {
+#ifdef VLSIGR_HAVE_ZLIB
+    case Compression::Gzip: return std::make_unique<GzipDecoder>(data, size);
+#endif
+#ifdef VLSIGR_HAVE_ZSTD
+    case Compression::Zstd: return std::make_unique<ZstdDecoder>(data, size);
+#endif
+    default: break;
+    }
+    (void)data;
+    (void)size;
+    throw std::runtime_error("unsupported compressed input");
+}
+
+}  // namespace
+
+Compression detect_compression(const char* data, std::size_t size) {
+    if (has_magic(data, size, kGzipMagic, sizeof(kGzipMagic))) return Compression::Gzip;
+    if (has_magic(data, size, kZstdMagic, sizeof(kZstdMagic))) return Compression::Zstd;
+    return Compression::None;
+}
+
+bool compression_supported(Compression c) {
+    switch (c) {
+    case Compression::None: return true;
+#ifdef VLSIGR_HAVE_ZLIB
+    case Compression::Gzip: return true;
+#endif
+#ifdef VLSIGR_HAVE_ZSTD
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+DecompressingSource::DecompressingSource(const char* data, std::size_t size, Compression c,
+                                         std::size_t block_size, int depth)
+    : data_(data), size_(size), kind_(c) {
+    if (c == Compression::None || !compression_supported(c))
+        throw std::runtime_error(c == Compression::Gzip ? "gzip input needs a build with zlib"
+                                 : c == Compression::Zstd ? "zstd input needs a build with libzstd"
+                                                          : "input is not compressed");
+    // depth blocks in flight plus the one the consumer holds.
+    blocks_.resize(static_cast<std::size_t>(std::max(1, depth)) + 1);
+    for (std::size_t i = 0; i < blocks_.size(); i++) {
+        blocks_[i].buf.resize(std::max<std::size_t>(1, block_size));
+        free_.push_back(static_cast<int>(i));
+    }
+    worker_ = std::thread([this] { produce(); });
+}
+
+DecompressingSource::~DecompressingSource() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        cancel_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+bool DecompressingSource::next(const char*& begin, const char*& end) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (held_ >= 0) {
+        free_.push_back(held_);
+        held_ = -1;
+        cv_.notify_all();
+    }
+    cv_.wait(lk, [this] { return !filled_.empty() || done_; });
+    if (!filled_.empty()) {
+        held_ = filled_.front();
+        filled_.pop_front();
+        begin = blocks_[held_].buf.data();
+        end = begin + blocks_[held_].size;
+        return true;
+    }
+    if (error_) {
+        auto err = error_;
+        error_ = nullptr;
+        std::rethrow_exception(err);
+    }
+    return false;
+}
+
+int DecompressingSource::acquire_free() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return !free_.empty() || cancel_; });
+    if (cancel_) return -1;
+    int idx = free_.front();
+    free_.pop_front();
+    return idx;
+}
+
+void DecompressingSource::publish(int idx) {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        filled_.push_back(idx);
+    }
+    cv_.notify_all();
+}
+
+void DecompressingSource::produce() {
+    std::exception_ptr err;
+    try {
+        auto dec = make_decoder(kind_, data_, size_);
+        while (true) {
+            int idx = acquire_free();
+            if (idx < 0) break;
+            auto& b = blocks_[idx];
+            b.size = dec->read(b.buf.data(), b.buf.size());
+            if (b.size == 0) break;
+            publish(idx);
+        }
+    } catch (...) {
+        err = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        error_ = err;
+        done_ = true;
+    }
+    cv_.notify_all();
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,70 @@
+#pragma once
+
+// Streaming decompression of compressed ISPD inputs (.gr.gz, .gr.zst).
+// A background thread inflates the (mmapped) compressed bytes into a small
+// ring of large blocks that the TextScanner consumes, so decompression and
+// parsing overlap and nothing is written to disk. gzip needs zlib
+// (VLSIGR_HAVE_ZLIB), zstd needs libzstd (VLSIGR_HAVE_ZSTD); both are
+// detected at build time.
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "router/text_scanner.hpp"
+
+namespace vlsigr {
+
+enum class Compression { None, Gzip, Zstd };
+
+// Identify the format from its magic bytes (1f 8b for gzip, 28 b5 2f fd for zstd).
+Compression detect_compression(const char* data, std::size_t size);
+
+// False if this build cannot decode the given format.
+bool compression_supported(Compression c);
+
+class DecompressingSource : public ChunkSource {
+public:
+    static constexpr std::size_t kDefaultBlockSize = std::size_t(4) << 20;
+    static constexpr int kDefaultDepth = 3;
+
+    // `data` must outlive the source. Throws std::runtime_error if the format is
+    // not supported by this build; decode errors surface from next().
+    DecompressingSource(const char* data, std::size_t size, Compression c,
+                        std::size_t block_size = kDefaultBlockSize, int depth = kDefaultDepth);
+    ~DecompressingSource() override;
+
+    DecompressingSource(const DecompressingSource&) = delete;
+    DecompressingSource& operator=(const DecompressingSource&) = delete;
+
+    bool next(const char*& begin, const char*& end) override;
+
+private:
+    struct Block {
+        std::vector<char> buf;
+        std::size_t size = 0;
+    };
+
+    const char* data_;
+    std::size_t size_;
+    Compression kind_;
+    std::vector<Block> blocks_;
+    std::deque<int> free_, filled_;
+    int held_ = -1;           // block currently handed to the consumer
+    bool done_ = false;       // producer finished (or failed)
+    bool cancel_ = false;     // consumer went away
+    std::exception_ptr error_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread worker_;
+
+    void produce();
+    int acquire_free();
+    void publish(int idx);
+};
+
+}  // namespace vlsigr
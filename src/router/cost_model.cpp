@@ -1,44 +1,161 @@
 #include "cost_model.hpp"
+#include "router/simd.hpp"
+#include "router/soa_grid_graph.hpp"
 #include "router/thread_pool.hpp"
-#include <immintrin.h>  // for target attribute if compiler uses it
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 
 namespace vlsigr {
 
+namespace {
+
+using Usage = SoAGridGraph::Usage;
+
+// pow(he, 3.6) / 100 for he < HISTSZ: the selcost 2 history term, which
+// does not depend on selcost, so one table serves every model.
+const double* history_table() {
+    static const std::vector<double> table = [] {
+        std::vector<double> t(CostModel::HISTSZ);
+        for (int he = 0; he < CostModel::HISTSZ; he++) t[he] = std::pow(he, 3.6) / 100.0;
+        return t;
+    }();
+    return table.data();
+}
+
+template<typename Model>
+void cost_range_scalar(const Model& m, const Usage* use, const int* he, EdgeCost* cost,
+                       std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++)
+        cost[i] = m.edge_cost(use[i].demand, use[i].cap, he[i]);
+}
+
+#ifdef VLSIGR_AVX2
+static_assert(sizeof(Usage) == 16 && offsetof(Usage, cap) == 0 && offsetof(Usage, demand) == 4,
+              "cost_range_avx2 transposes {cap, demand, ...} quads");
+
+// Gather t[idx] for four indices. The masked form with an explicit source
+// avoids GCC's maybe-uninitialized warning on _mm256_i32gather_pd.
+__attribute__((target("avx2")))
+inline __m256d gather4(const double* t, __m128i idx) {
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), t, idx,
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+// Store four costs as EdgeCost: to_edge_cost's scale, saturation and
+// rounding (cvtpd_epi32 rounds per MXCSR, nearest by default).
+__attribute__((target("avx2")))
+inline void store4(EdgeCost* cost, __m256d c) {
+#ifdef VLSIGR_COST_FIXED
+    c = _mm256_min_pd(_mm256_mul_pd(c, _mm256_set1_pd(kCostScale)), _mm256_set1_pd(kCostInf));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(cost), _mm256_cvtpd_epi32(c));
+#else
+    _mm256_storeu_pd(cost, c);
+#endif
+}
+
+// Four edges per step: transpose cap/demand out of the Usage records, gather
+// both tables and evaluate in the scalar operation order (no FMA), so results
+// match cost_range_scalar exactly. Steps with a history value outside the
+// table fall back to scalar.
+template<typename Model>
+__attribute__((target("avx2")))
+void cost_range_avx2(const Model& m, const double* pe_table, const double* hist, const Usage* use,
+                     const int* he, EdgeCost* cost, std::size_t begin, std::size_t end) {
+    const __m128i off = _mm_set1_epi32(CostModel::COSTOFF + 1);
+    const __m128i lo = _mm_setzero_si128(), hi = _mm_set1_epi32(CostModel::COSTSZ - 1);
+    const __m256d be = _mm256_set1_pd(200.0);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        auto u = reinterpret_cast<const __m128i*>(use + i);
+        __m128i t0 = _mm_unpacklo_epi32(_mm_loadu_si128(u), _mm_loadu_si128(u + 1));
+        __m128i t1 = _mm_unpacklo_epi32(_mm_loadu_si128(u + 2), _mm_loadu_si128(u + 3));
+        __m128i cap = _mm_unpacklo_epi64(t0, t1), demand = _mm_unpackhi_epi64(t0, t1);
+        __m128i idx = _mm_add_epi32(_mm_sub_epi32(demand, cap), off);
+        idx = _mm_min_epi32(_mm_max_epi32(idx, lo), hi);
+        __m256d pe = gather4(pe_table, idx);
+        if constexpr (Model::policy::history) {
+            __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(he + i));
+            // Unsigned compare also sends negative history to the scalar path.
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_min_epu32(h, _mm_set1_epi32(CostModel::HISTSZ - 1)), h)) != 0xffff) {
+                cost_range_scalar(m, use, he, cost, i, i + 4);
+                continue;
+            }
+            __m256d dah = gather4(hist, h);
+            store4(cost + i, _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd(1.0), dah), pe), be));
+        } else {
+            store4(cost + i, _mm256_add_pd(_mm256_mul_pd(pe, _mm256_set1_pd(10.0)), be));
+        }
+    }
+    cost_range_scalar(m, use, he, cost, i, end);
+    // GCC can drop the implicit vzeroupper from cloned instantiations; dirty
+    // upper halves then slow every SSE instruction after (libm's log2 in
+    // sort_twopins ran 10x slower).
+    _mm256_zeroupper();
+}
+
+#endif
+
+}  // namespace
+
+CostModel::CostModel(int sel): selcost(0), cost_he(history_table()) {
+    set_selcost(sel);
+}
+
+void CostModel::set_selcost(int sel) {
+    if (sel < MildCost::selcost || sel > AggressiveCost::selcost)
+        throw std::runtime_error("CostModel: selcost must be 0, 1 or 2, got " + std::to_string(sel));
+    selcost = sel;
+    build_cost_pe();
+}
+
 void CostModel::build_cost_pe() {
     constexpr double z = 200.0;
+    const double slope = visit([](const auto& m) { return std::decay_t<decltype(m)>::policy::slope; });
     for (int i = 0; i < COSTSZ; i++) {
         int of = i - COSTOFF;
-        switch (selcost) {
-            case 0:
-                cost_pe[i] = 1 + z / (1 + std::exp(-0.3 * of));
-                break;
-            case 1:
-                cost_pe[i] = 1 + z / (1 + std::exp(-0.5 * of));
-                break;
-            case 2:
-            default:
-                cost_pe[i] = 1 + z / (1 + std::exp(-0.7 * of));
-                break;
-        }
+        cost_pe[i] = 1 + z / (1 + std::exp(-slope * of));
     }
 }
 
-double CostModel::calc_cost(const Edge& e) const {
-    // follow legacy cost: demand+1 to anticipate usage
-    int demand = e.demand + 1;
-    int cap = e.cap;
-    int of = demand - cap;
-    auto pe = get_cost_pe(of);
+void CostModel::build_cost_range(SoAGridGraph& grid, std::size_t begin, std::size_t end) const {
+    visit([&](const auto& m) {
+#ifdef VLSIGR_AVX2
+        if (have_avx2()) {
+            cost_range_avx2(m, cost_pe, cost_he, grid.usage_data(), grid.he_data(), grid.cost_data(), begin, end);
+            return;
+        }
+#endif
+        cost_range_scalar(m, grid.usage_data(), grid.he_data(), grid.cost_data(), begin, end);
+    });
+}
 
-    if (selcost == 2) {
-        auto dah = std::pow(e.he, 3.6) / 100.0;
-        auto be = 200.0;
-        return (1 + dah) * pe + be;
+void CostModel::build_cost(SoAGridGraph& grid) {
+    // Chunks below this are not worth a pool round trip.
+    constexpr std::size_t kMinChunk = std::size_t(1) << 16;
+    const std::size_t n = grid.size();
+    const std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t chunks = std::min(workers, n / kMinChunk);
+    if (chunks < 2) {
+        build_cost_range(grid, 0, n);
+        return;
+    }
+    // Chunk 0 runs on this thread; steps are multiples of 4 so only the last chunk has a scalar tail.
+    const std::size_t step = (n / chunks + 3) & ~std::size_t(3);
+    std::vector<std::future<void>> futs;
+    for (std::size_t b = step; b < n; b += step) {
+        auto e = std::min(n, b + step);
+        futs.emplace_back(thread_pool().enqueue([this, &grid, b, e] { build_cost_range(grid, b, e); }));
     }
-    return pe * 10.0 + 200.0;
+    build_cost_range(grid, 0, std::min(n, step));
+    for (auto& f : futs) f.get();
 }
 
 }  // namespace vlsigr
-
-
-
@@ -4,7 +4,9 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
+#include "router/edge_cost.hpp"
 #include "router/grid_graph.hpp"
 
 namespace vlsigr {
@@ -15,41 +17,111 @@ struct Edge {
     int he;   // history
     int of;   // overflow count
     int used;
-    double cost;
-    explicit Edge(int c = 0): cap(c), demand(0), he(1), of(0), used(0), cost(1.0) {}
+    EdgeCost cost;
+    explicit Edge(int c = 0): cap(c), demand(0), he(1), of(0), used(0), cost(kCostScale) {}
     bool overflow() const { return cap < demand; }
 };
 
-class CostModel {
-public:
+template<typename Layout, typename Access> class BasicSoAGridGraph;
+
+// Cost schemes, selected by selcost: how steeply overflow is penalised and
+// whether edge history (Edge::he) scales the penalty. RoutingCore also
+// orders two-pins for rerouting by scheme (RoutingCore::score).
+struct MildCost {
+    static constexpr int selcost = 0;
+    static constexpr double slope = 0.3;
+    static constexpr bool history = false;
+};
+struct SteeperCost {
+    static constexpr int selcost = 1;
+    static constexpr double slope = 0.5;
+    static constexpr bool history = false;
+};
+struct AggressiveCost {
+    static constexpr int selcost = 2;
+    static constexpr double slope = 0.7;
+    static constexpr bool history = true;
+};
+
+struct CostTables {
     static constexpr int COSTSZ  = 1024;
     static constexpr int COSTOFF = 256;
+    static constexpr int HISTSZ  = 8192;  // history terms tabulated
+};
+
+// A CostModel with its scheme fixed at compile time, so calc_cost does not
+// branch on selcost. A view of the model's tables; see CostModel::visit.
+template<typename Policy>
+class BasicCostModel : public CostTables {
+public:
+    using policy = Policy;
+
+    BasicCostModel(const double* pe, const double* hist): pe_(pe), hist_(hist) {}
+
+    double calc_cost(int demand, int cap, int he) const {
+        // follow legacy cost: demand+1 to anticipate usage
+        int i = demand + 1 - cap + COSTOFF;
+        auto pe = pe_[i <= 0 ? 0 : i >= COSTSZ ? COSTSZ - 1 : i];
+        if constexpr (Policy::history) {
+            auto dah = he >= 0 && he < HISTSZ ? hist_[he] : std::pow(he, 3.6) / 100.0;
+            return (1 + dah) * pe + 200.0;
+        } else {
+            return pe * 10.0 + 200.0;
+        }
+    }
+    // calc_cost as stored in the grid (see edge_cost.hpp).
+    EdgeCost edge_cost(int demand, int cap, int he) const { return to_edge_cost(calc_cost(demand, cap, he)); }
 
-    explicit CostModel(int sel = 0): selcost(sel) { build_cost_pe(); }
+private:
+    const double* pe_;    // overflow penalty by overflow + COSTOFF
+    const double* hist_;  // pow(he, 3.6) / 100 by he
+};
 
-    void set_selcost(int sel) { selcost = sel; build_cost_pe(); }
+class CostModel : public CostTables {
+public:
+    // Throws std::runtime_error unless sel is 0, 1 or 2.
+    explicit CostModel(int sel = 0);
+
+    void set_selcost(int sel);
+
+    // f(BasicCostModel<Policy>) for the current scheme: dispatch on selcost
+    // once and run a whole loop with the scheme compiled in.
+    template<typename F>
+    decltype(auto) visit(F&& f) const {
+        switch (selcost) {
+            case MildCost::selcost: return f(BasicCostModel<MildCost>(cost_pe, cost_he));
+            case SteeperCost::selcost: return f(BasicCostModel<SteeperCost>(cost_pe, cost_he));
+            default: return f(BasicCostModel<AggressiveCost>(cost_pe, cost_he));
+        }
+    }
 
     // Calculate cost for one edge.
-    double calc_cost(const Edge& e) const;
+    double calc_cost(const Edge& e) const { return calc_cost(e.demand, e.cap, e.he); }
+    double calc_cost(int demand, int cap, int he) const {
+        return visit([&](const auto& m) { return m.calc_cost(demand, cap, he); });
+    }
+    EdgeCost edge_cost(const Edge& e) const { return to_edge_cost(calc_cost(e)); }
+    EdgeCost edge_cost(int demand, int cap, int he) const { return to_edge_cost(calc_cost(demand, cap, he)); }
 
-    // Recompute cost for all edges in the grid.
+    // Recompute cost for all edges in the grid. The SoA overload runs in
+    // chunks on thread_pool() workers (do not call it from a pool task) with
+    // an AVX2 kernel when the CPU has one; every path gives edge_cost's
+    // values bit for bit.
     template<typename Grid>
     void build_cost(Grid& grid) {
         for (auto it = grid.begin(); it != grid.end(); ++it)
-            it->cost = calc_cost(*it);
+            it->cost = edge_cost(*it);
     }
+    void build_cost(BasicSoAGridGraph<GridLayout, UncheckedAccess>& grid);
 
 private:
     int selcost;  // 0: mild, 1: steeper, 2: aggressive
     double cost_pe[COSTSZ];
+    const double* cost_he;  // shared history table
 
     void build_cost_pe();
-    inline double get_cost_pe(int of) const {
-        int i = of + COSTOFF;
-        if (i <= 0) return cost_pe[0];
-        if (i >= COSTSZ) return cost_pe[COSTSZ-1];
-        return cost_pe[i];
-    }
+    void build_cost_range(BasicSoAGridGraph<GridLayout, UncheckedAccess>& grid,
+                          std::size_t begin, std::size_t end) const;
 };
 
 }  // namespace vlsigr
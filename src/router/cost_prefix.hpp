@@ -0,0 +1,137 @@
+#pragma once
+
+// Running sums of edge costs along every wire: a Fenwick tree per row of
+// horizontal edges (by x) and per column of vertical edges (by y), so the cost
+// of a long straight run is O(log n). Pattern routing reads whole legs from
+// it (patterns::Lshape / Zshape overloads).
+//
+// The grid stays the owner of the costs. Writers touch() the edges they
+// change, and the trees catch up lazily, only when a run too long to sum
+// directly needs them; an edge whose cost came back to what the trees hold
+// (a net's edges masked by del_cost and restored by add_cost) costs nothing.
+//
+// With CostType=fixed the sums are exact (int64), so run costs equal
+// left-to-right cost_add sums; with double they can differ in the last bits,
+// and updates by difference drift by as much, which a build() clears.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "router/edge_cost.hpp"
+#include "router/edge_set.hpp"
+#include "router/soa_grid_graph.hpp"
+
+namespace vlsigr {
+
+#ifdef VLSIGR_COST_FIXED
+using CostSum = std::int64_t;
+#else
+using CostSum = double;
+#endif
+
+// A sum as an EdgeCost, saturated like cost_add.
+inline EdgeCost clamp_cost(CostSum s) {
+#ifdef VLSIGR_COST_FIXED
+    return s < kCostInf ? static_cast<EdgeCost>(s) : kCostInf;
+#else
+    return s;
+#endif
+}
+
+template<typename Grid>
+class BasicCostPrefix {
+    static constexpr int kDirectRun = 16;  // longest run summed from the grid edge by edge
+
+    const Grid* grid_ = nullptr;
+    std::size_t w_ = 0, h_ = 0;
+    // Brought up to date by const queries (flush).
+    mutable std::vector<CostSum> tree_;   // rows (w-1 edges each), then columns (h-1 edges each)
+    mutable std::vector<EdgeCost> held_;  // by grid slot: the cost the trees hold
+    mutable EdgeSet dirty_;               // grid slots touched since the last flush
+
+    std::size_t base(bool hori, int across) const {
+        auto c = static_cast<std::size_t>(across);
+        return hori ? c * (w_ - 1) : h_ * (w_ - 1) + c * (h_ - 1);
+    }
+
+    // Sum of the first n edges of the wire at slot b.
+    CostSum prefix(std::size_t b, std::size_t n) const {
+        CostSum s = 0;
+        for (; n > 0; n &= n - 1) s += tree_[b + n - 1];
+        return s;
+    }
+
+    void flush() const {
+        for (auto e : dirty_) {
+            auto c = grid_->cost(e);
+            auto delta = static_cast<CostSum>(c) - static_cast<CostSum>(held_[e]);
+            if (delta == 0) continue;
+            held_[e] = c;
+            int x, y;
+            bool hori;
+            grid_->idx2rp(e, x, y, hori);
+            if (!grid_->contains(x, y, hori)) continue;  // layout padding: no wire holds it
+            auto b = base(hori, hori ? y : x);
+            auto n = hori ? w_ - 1 : h_ - 1;
+            for (auto i = static_cast<std::size_t>(hori ? x : y) + 1; i <= n; i += i & (~i + 1))
+                tree_[b + i - 1] += delta;
+        }
+        dirty_.clear();
+    }
+
+public:
+    // Rebuild from grid's current costs, O(edges); grid must outlive the sums.
+    void build(const Grid& grid) {
+        grid_ = &grid;
+        w_ = grid.width();
+        h_ = grid.height();
+        held_.resize(grid.size());
+        for (std::size_t e = 0; e < grid.size(); e++) held_[e] = grid.cost(e);
+        dirty_.reset(grid.size());
+        tree_.resize(h_ * (w_ - 1) + w_ * (h_ - 1));
+        auto fill = [&](std::size_t b, std::size_t n, auto line) {
+            for (std::size_t i = 0; i < n; i++) tree_[b + i] = line[static_cast<int>(i)];
+            for (std::size_t i = 1; i <= n; i++) {
+                auto j = i + (i & (~i + 1));
+                if (j <= n) tree_[b + j - 1] += tree_[b + i - 1];
+            }
+        };
+        for (std::size_t y = 0; y < h_; y++) fill(base(true, static_cast<int>(y)), w_ - 1, grid.row_cost(static_cast<int>(y)));
+        for (std::size_t x = 0; x < w_; x++) fill(base(false, static_cast<int>(x)), h_ - 1, grid.col_cost(static_cast<int>(x)));
+    }
+
+    // The grid cost of slot e changed. Padding slots are ignored at flush.
+    void touch(std::size_t e) { dirty_.insert(e); }
+
+    // Cost of one edge, from the grid.
+    EdgeCost edge(bool hori, int across, int along) const {
+        return hori ? grid_->row_cost(across)[along] : grid_->col_cost(across)[along];
+    }
+
+    // Cost of the edges between along coordinates a and b (either order) of
+    // row `across` (hori) or column `across`; run() saturates it like cost_add.
+    CostSum sum(bool hori, int across, int a, int b) const {
+        if (a > b) std::swap(a, b);
+        CostSum s = 0;
+        if (b - a <= kDirectRun) {
+            if (hori) {
+                auto row = grid_->row_cost(across);
+                for (int i = a; i < b; i++) s += row[i];
+            } else {
+                auto col = grid_->col_cost(across);
+                for (int i = a; i < b; i++) s += col[i];
+            }
+            return s;
+        }
+        if (!dirty_.empty()) flush();
+        auto w = base(hori, across);
+        return prefix(w, static_cast<std::size_t>(b)) - prefix(w, static_cast<std::size_t>(a));
+    }
+    EdgeCost run(bool hori, int across, int a, int b) const { return clamp_cost(sum(hori, across, a, b)); }
+};
+
+using CostPrefix = BasicCostPrefix<SoAGridGraph>;
+
+}  // namespace vlsigr
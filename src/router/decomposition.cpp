@@ -0,0 +1,140 @@
+#include "decomposition.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+namespace vlsigr {
+
+void project_net_pins(IspdData& data, Net& net) {
+    auto out3D = data.pin3D_coords.data() + net.pin_begin;
+    auto out2D = data.pin2D_coords.data() + net.pin_begin;
+    int n3D = 0, n2D = 0;
+    for (auto& _pin : data.pins(net)) {
+        int x = (std::get<0>(_pin) - data.lowerLeftX) / data.tileWidth;
+        int y = (std::get<1>(_pin) - data.lowerLeftY) / data.tileHeight;
+        int z = std::get<2>(_pin) - 1;
+
+        if (std::any_of(out3D, out3D + n3D, [x, y, z](const auto& pin) {
+            return pin.x == x && pin.y == y && pin.z == z;
+        })) continue;
+        out3D[n3D++] = Point(x, y, z);
+
+        if (std::any_of(out2D, out2D + n2D, [x, y](const auto& pin) {
+            return pin.x == x && pin.y == y;
+        })) continue;
+        out2D[n2D++] = Point(x, y, 0);
+    }
+    net.pin3D_count = n3D;
+    net.pin2D_count = n2D;
+}
+
+bool routable_net(const Net& net) {
+    return net.pin3D_count <= 1000 && net.pin2D_count > 1;
+}
+
+void decompose_net(const IspdData& data, Net& net) {
+    auto pin2D = data.pin2D(net);
+    auto sz = pin2D.size();
+    net.twopin.clear();
+    if (sz == 0) return;
+    net.twopin.reserve(sz - 1);
+    std::vector<bool> vis(sz, false);
+    std::priority_queue<std::tuple<int, std::size_t, std::size_t>> pq{};
+
+    auto add = [&](std::size_t i) {
+        vis[i] = true;
+        auto [xi, yi, zi] = pin2D[i];
+        for (std::size_t j = 0; j < sz; j++) if (!vis[j]) {
+            auto [xj, yj, zj] = pin2D[j];
+            auto d = std::abs(xi - xj) + std::abs(yi - yj);
+            pq.emplace(-d, i, j);
+        }
+    };
+
+    add(0);
+    while (!pq.empty()) {
+        auto [d, i, j] = pq.top();
+        pq.pop();
+        if (vis[j]) continue;
+        TwoPin tp;
+        tp.from = pin2D[i];
+        tp.to = pin2D[j];
+        net.twopin.emplace_back(tp);
+        add(j);
+    }
+}
+
+void size_projected_pins(IspdData& data) {
+    data.pin2D_coords.resize(data.pin_coords.size());
+    data.pin3D_coords.resize(data.pin_coords.size());
+}
+
+void prepare_nets(IspdData& data) {
+    size_projected_pins(data);
+    // Filter nets: remove nets with >1000 pins or <=1 2D pins
+    data.nets.erase(
+        std::remove_if(data.nets.begin(), data.nets.end(), [&](auto& net) {
+            project_net_pins(data, net);
+            return !routable_net(net);
+        }),
+        data.nets.end()
+    );
+    data.numNet = (int)data.nets.size();
+    for (auto& net : data.nets)
+        decompose_net(data, net);
+    data.decomposed = true;
+}
+
+namespace {
+
+void prepare_hook(IspdData& data, Net& net) {
+    project_net_pins(data, net);
+    if (routable_net(net)) decompose_net(data, net);
+}
+
+// Drop the nets the hook left undecomposed, mirroring prepare_nets' filter.
+void finish_streamed(IspdData& data) {
+    data.nets.erase(
+        std::remove_if(data.nets.begin(), data.nets.end(), [](const Net& net) {
+            return !routable_net(net);
+        }),
+        data.nets.end()
+    );
+    data.numNet = (int)data.nets.size();
+    data.decomposed = true;
+}
+
+}  // namespace
+
+IspdData parse_ispd_file_prepared(const std::string& path, ParseOptions opt) {
+    opt.net_hook = prepare_hook;
+    auto data = parse_ispd_file(path, opt);
+    finish_streamed(data);
+    return data;
+}
+
+IspdData parse_ispd_buffer_prepared(const char* buf, std::size_t size, ParseOptions opt) {
+    opt.net_hook = prepare_hook;
+    auto data = parse_ispd_buffer(buf, size, opt);
+    finish_streamed(data);
+    return data;
+}
+
+void reset_routing_state(IspdData& data) {
+    for (auto& net : data.nets) {
+        net.overflow = net.overflow_twopin = net.wlen = 0;
+        net.cost = 0.0;
+        for (auto& tp : net.twopin) {
+            tp.path.clear();
+            tp.reroute = 0;
+            tp.overflow = false;
+            tp.ripup = false;
+            tp.id = -1;
+        }
+    }
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,40 @@
+#pragma once
+
+// Net preparation shared by RoutingCore, snapshots and the streaming loader:
+// pin projection onto the 2D/3D tile grid and MST two-pin decomposition.
+
+#include <cstddef>
+#include <string>
+
+#include "router/ispd_data.hpp"
+
+namespace vlsigr {
+
+// Project raw pin coordinates to tile indices, deduplicating pin3D/pin2D.
+// Writes into the net's slots of data.pin2D_coords/pin3D_coords, which must
+// already cover data.pin_coords (see size_projected_pins).
+void project_net_pins(IspdData& data, Net& net);
+
+// Nets kept for routing: at most 1000 distinct 3D pins and at least two 2D pins.
+bool routable_net(const Net& net);
+
+// Rebuild net.twopin as a Manhattan MST over pin2D.
+void decompose_net(const IspdData& data, Net& net);
+
+// Size the projected pin arrays to match the raw pin store.
+void size_projected_pins(IspdData& data);
+
+// Project, filter and decompose every net; sets data.decomposed.
+void prepare_nets(IspdData& data);
+
+// Streaming variants of parse + prepare_nets: each net is projected and
+// decomposed on a pool worker as soon as it is parsed, so preparation overlaps
+// the read. The result is identical to parse_ispd_* followed by prepare_nets.
+IspdData parse_ispd_file_prepared(const std::string& path, ParseOptions opt = {});
+IspdData parse_ispd_buffer_prepared(const char* data, std::size_t size, ParseOptions opt = {});
+
+// Clear per-twopin routing state (paths, counters, flags) so a decomposed
+// design can be routed again from scratch.
+void reset_routing_state(IspdData& data);
+
+}  // namespace vlsigr
@@ -0,0 +1,98 @@
+#include "eco.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
+
+#include "router/mapped_file.hpp"
+#include "router/text_scanner.hpp"
+
+namespace vlsigr {
+
+namespace {
+
+void expect(bool cond, const std::string& msg) {
+    if (!cond) throw std::runtime_error("netlist delta: " + msg);
+}
+
+void read_eco_net(TextScanner& sc, EcoNet& net) {
+    int num_pins = 0;
+    expect(sc.read_token(net.name) && sc.read_int(net.id) && sc.read_int(num_pins) &&
+           sc.read_int(net.minimumWidth) && num_pins >= 0, "failed to read net header");
+    net.pins.reserve(static_cast<std::size_t>(num_pins));
+    for (int i = 0; i < num_pins; i++) {
+        int x, y, z;
+        expect(sc.read_int(x) && sc.read_int(y) && sc.read_int(z), "failed to read pin of net " + net.name);
+        net.pins.emplace_back(x, y, z);
+    }
+}
+
+}  // namespace
+
+NetlistDelta parse_netlist_delta_buffer(const char* data, std::size_t size) {
+    NetlistDelta delta;
+    TextScanner sc(data, data + size);
+    std::string cmd;
+    while (sc.read_token(cmd)) {
+        if (cmd[0] == '#') {
+            sc.skip_line();
+        } else if (cmd == "remove") {
+            std::string name;
+            expect(sc.read_token(name), "failed to read removed net name");
+            delta.removed.push_back(std::move(name));
+        } else if (cmd == "add") {
+            read_eco_net(sc, delta.added.emplace_back());
+        } else if (cmd == "update") {
+            read_eco_net(sc, delta.updated.emplace_back());
+        } else {
+            expect(false, "unknown command '" + cmd + "'");
+        }
+    }
+    return delta;
+}
+
+NetlistDelta parse_netlist_delta_file(const std::string& path) {
+    MappedFile file(path);
+    return parse_netlist_delta_buffer(file.data(), file.size());
+}
+
+void check_delta(const IspdData& data, const std::function<bool(const std::string&)>& known,
+                 const NetlistDelta& delta) {
+    std::unordered_set<std::string> seen;
+    auto once = [&](const std::string& name) {
+        expect(seen.insert(name).second, "net " + name + " is listed twice");
+    };
+    auto inside = [&](const EcoNet& net) {
+        for (auto& [x, y, z] : net.pins)
+            expect(data.inside_die(x, y, z), "pin of net " + net.name + " lies outside the die");
+    };
+    for (auto& name : delta.removed) {
+        once(name);
+        expect(known(name), "unknown net " + name);
+    }
+    for (auto& net : delta.updated) {
+        once(net.name);
+        expect(known(net.name), "unknown net " + net.name);
+        inside(net);
+    }
+    for (auto& net : delta.added) {
+        once(net.name);
+        expect(!known(net.name), "net " + net.name + " already exists");
+        inside(net);
+    }
+}
+
+void assign_net(IspdData& data, Net& net, const EcoNet& src) {
+    net.name = src.name;
+    net.id = src.id;
+    net.minimumWidth = src.minimumWidth;
+    net.numPins = static_cast<int>(src.pins.size());
+    net.pin_begin = data.pin_coords.size();
+    net.pin_count = net.numPins;
+    net.pin2D_count = net.pin3D_count = 0;
+    net.twopin.clear();
+    data.pin_coords.insert(data.pin_coords.end(), src.pins.begin(), src.pins.end());
+    data.pin2D_coords.resize(data.pin_coords.size());
+    data.pin3D_coords.resize(data.pin_coords.size());
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,58 @@
+#pragma once
+
+// Netlist deltas for incremental (ECO) rerouting of an already-routed design
+// (see RoutingCore::eco). Nets are matched by name.
+//
+// Text format, one command per line ('#' starts a comment line):
+//   remove <name>
+//   add <name> <id> <numPins> <minWidth>      followed by numPins "x y layer" lines
+//   update <name> <id> <numPins> <minWidth>   same, replacing an existing net's pins
+
+#include <cstddef>
+#include <string>
+#include <functional>
+#include <vector>
+
+#include "router/ispd_data.hpp"
+
+namespace vlsigr {
+
+struct EcoNet {
+    std::string name;
+    int id = 0;
+    int minimumWidth = 0;
+    std::vector<PinCoord> pins;
+};
+
+struct NetlistDelta {
+    std::vector<std::string> removed;
+    std::vector<EcoNet> added;     // must not exist yet
+    std::vector<EcoNet> updated;   // existing nets whose pins moved
+
+    bool empty() const { return removed.empty() && added.empty() && updated.empty(); }
+};
+
+struct EcoStats {
+    int removed = 0, updated = 0, added = 0;
+    int rerouted_nets = 0;      // changed nets plus nets they pushed into overflow
+    int rerouted_twopins = 0;
+    int overflow = 0;           // overflow left on the rerouted nets' edges
+    double runtime_sec = 0.0;
+};
+
+// Throw std::runtime_error on malformed input.
+NetlistDelta parse_netlist_delta_buffer(const char* data, std::size_t size);
+NetlistDelta parse_netlist_delta_file(const std::string& path);
+
+// Throw std::runtime_error unless the delta applies to data: removed/updated
+// nets exist (known(name)), added nets do not, no net is listed twice and
+// every pin lies inside the die.
+void check_delta(const IspdData& data, const std::function<bool(const std::string&)>& known,
+                 const NetlistDelta& delta);
+
+// Give net src's header and pins. The pins are appended to the design's pin
+// store (the net's previous slot is left unused) and the net is not projected
+// or decomposed yet.
+void assign_net(IspdData& data, Net& net, const EcoNet& src);
+
+}  // namespace vlsigr
@@ -0,0 +1,46 @@
+#pragma once
+
+// Stored edge cost type, chosen at build time (`make CostType=fixed`):
+//   double  (default) the cost model's values as they are
+//   fixed   int32 fixed point, kCostScale units per 1.0 of cost, rounded to
+//           nearest and saturated at kCostInf. Path sums saturate too (cost_add).
+// A unit edge costs at least 200, so 1/16 resolves every edge to better than
+// 0.05%, and int32 holds edges up to ~1.3e8 (selcost 2 reaches that only for
+// history above ~150) and paths over ten thousand edges.
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace vlsigr {
+
+#ifdef VLSIGR_COST_FIXED
+using EdgeCost = std::int32_t;
+constexpr EdgeCost kCostScale = 16;
+constexpr EdgeCost kCostInf = std::numeric_limits<std::int32_t>::max();
+constexpr const char* kEdgeCostName = "fixed";
+
+// Round like _mm256_cvtpd_epi32 (current rounding mode, nearest by default),
+// so batch and scalar cost builds agree. NaN saturates, as in the batch build.
+inline EdgeCost to_edge_cost(double c) {
+    c *= kCostScale;
+    if (std::isnan(c) || c >= kCostInf) return kCostInf;
+    return static_cast<EdgeCost>(std::nearbyint(c));
+}
+inline double cost_value(EdgeCost c) { return static_cast<double>(c) / kCostScale; }
+inline EdgeCost cost_add(EdgeCost a, EdgeCost b) {
+    auto s = static_cast<std::int64_t>(a) + b;
+    return s < kCostInf ? static_cast<EdgeCost>(s) : kCostInf;
+}
+#else
+using EdgeCost = double;
+constexpr EdgeCost kCostScale = 1.0;
+constexpr EdgeCost kCostInf = std::numeric_limits<double>::infinity();
+constexpr const char* kEdgeCostName = "double";
+
+inline EdgeCost to_edge_cost(double c) { return c; }
+inline double cost_value(EdgeCost c) { return c; }
+inline EdgeCost cost_add(EdgeCost a, EdgeCost b) { return a + b; }
+#endif
+
+}  // namespace vlsigr
@@ -0,0 +1,41 @@
+#pragma once
+
+// Set of grid edge indices with a membership byte per edge: insert is O(1)
+// and idempotent, and iteration and clear() only visit members, so tracking
+// the few edges an iteration changes costs nothing per grid edge.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vlsigr {
+
+class EdgeSet {
+    std::vector<std::uint32_t> items_;  // insertion order
+    std::vector<char> in_;
+
+public:
+    // Empty set over edges [0, n).
+    void reset(std::size_t n) {
+        items_.clear();
+        in_.assign(n, 0);
+    }
+
+    bool contains(std::size_t e) const { return in_[e] != 0; }
+    void insert(std::size_t e) {
+        if (in_[e]) return;
+        in_[e] = 1;
+        items_.push_back(static_cast<std::uint32_t>(e));
+    }
+    void clear() {
+        for (auto e : items_) in_[e] = 0;
+        items_.clear();
+    }
+
+    std::size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+    std::vector<std::uint32_t>::const_iterator begin() const { return items_.begin(); }
+    std::vector<std::uint32_t>::const_iterator end() const { return items_.end(); }
+};
+
+}  // namespace vlsigr
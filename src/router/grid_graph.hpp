@@ -1,41 +1,301 @@
 #pragma once
 
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
 
 namespace vlsigr {
 
-template<typename T>
-class GridGraph {
+// Edge layouts: how a width x height tile grid's edges are numbered in the
+// grid containers. Vertical edges (x, y)-(x, y+1) come first, then horizontal
+// edges (x, y)-(x+1, y); each direction is a plane whose "along" coordinate
+// runs with its wires (y for vertical edges, x for horizontal ones).
+//
+// A layout provides width()/height(), contains(x, y, hori), num_slots() (the
+// storage size, which may include padding that maps to no edge),
+// hori_begin() (first slot of the horizontal plane), rp2idx and its inverse
+// idx2rp, and line(hori, across): the slots of one straight wire (a row of
+// horizontal edges or a column of vertical ones) by their along coordinate.
+// The grid containers take the layout as a template parameter; GridLayout
+// below is the build-wide default (make GridLayout=...).
+
+class GridExtent {
+protected:
     std::size_t w_ = 0, h_ = 0;
-    std::size_t vsz_ = 0, hsz_ = 0;
-    std::vector<T> edges_;
+
+    void reset_extent(std::size_t width, std::size_t height) { w_ = width; h_ = height; }
 
 public:
     std::size_t width()  const { return w_; }
     std::size_t height() const { return h_; }
 
+    bool contains(int x, int y, bool hori) const {
+        if (x < 0 || y < 0) return false;
+        auto ux = static_cast<std::size_t>(x), uy = static_cast<std::size_t>(y);
+        return hori ? ux + 1 < w_ && uy < h_ : ux < w_ && uy + 1 < h_;
+    }
+};
+
+// Each plane numbered along its wires: vertical edges column by column,
+// horizontal edges row by row, so walking a straight wire is a linear scan.
+// No padding. A 2D box sweep strides by a whole column/row in one direction.
+class WireLayout : public GridExtent {
+protected:
+    std::size_t vsz_ = 0, hsz_ = 0;
+
+    void reset(std::size_t width, std::size_t height) {
+        reset_extent(width, height);
+        vsz_ = w_ * (h_ - 1);
+        hsz_ = (w_ - 1) * h_;
+    }
+
+public:
+    static constexpr const char* name = "wire";
+
+    std::size_t num_slots() const { return vsz_ + hsz_; }
+    std::size_t hori_begin() const { return vsz_; }
+
     inline std::size_t rp2idx(int x, int y, bool hori) const {
         if (hori)
-            return static_cast<std::size_t>(x) * h_ + static_cast<std::size_t>(y) + vsz_;
-        return static_cast<std::size_t>(x) + static_cast<std::size_t>(y) * w_;
+            return static_cast<std::size_t>(y) * (w_ - 1) + static_cast<std::size_t>(x) + vsz_;
+        return static_cast<std::size_t>(x) * (h_ - 1) + static_cast<std::size_t>(y);
     }
 
+    struct Line {
+        std::size_t base;
+        std::size_t operator()(int along) const { return base + static_cast<std::size_t>(along); }
+    };
+    Line line(bool hori, int across) const {
+        auto c = static_cast<std::size_t>(across);
+        return {hori ? vsz_ + c * (w_ - 1) : c * (h_ - 1)};
+    }
+
+    // Inverse of rp2idx.
+    inline void idx2rp(std::size_t i, int& x, int& y, bool& hori) const {
+        hori = i >= vsz_;
+        if (hori) {
+            i -= vsz_;
+            y = static_cast<int>(i / (w_ - 1));
+            x = static_cast<int>(i % (w_ - 1));
+        } else {
+            x = static_cast<int>(i / (h_ - 1));
+            y = static_cast<int>(i % (h_ - 1));
+        }
+    }
+};
+
+// In-tile orders for TiledLayout: position of (along, across) inside a tile
+// of side 2^shift, and back.
+struct LinearTileOrder {
+    static std::size_t pos(unsigned along, unsigned across, int shift) {
+        return (static_cast<std::size_t>(across) << shift) | along;
+    }
+    static void unpos(std::size_t p, int shift, unsigned& along, unsigned& across) {
+        along = static_cast<unsigned>(p & ((std::size_t(1) << shift) - 1));
+        across = static_cast<unsigned>(p >> shift);
+    }
+};
+
+// Z-order (Morton): cells close in either direction share cache lines.
+struct ZTileOrder {
+    static std::uint32_t spread(std::uint32_t v) {  // ...dcba -> .d.c.b.a
+        v &= 0xffffu;
+        v = (v | (v << 8)) & 0x00ff00ffu;
+        v = (v | (v << 4)) & 0x0f0f0f0fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    }
+    static std::uint32_t compact(std::uint32_t v) {  // inverse of spread
+        v &= 0x55555555u;
+        v = (v | (v >> 1)) & 0x33333333u;
+        v = (v | (v >> 2)) & 0x0f0f0f0fu;
+        v = (v | (v >> 4)) & 0x00ff00ffu;
+        v = (v | (v >> 8)) & 0x0000ffffu;
+        return v;
+    }
+    static std::size_t pos(unsigned along, unsigned across, int /* shift */) {
+        return spread(along) | (spread(across) << 1);
+    }
+    static void unpos(std::size_t p, int /* shift */, unsigned& along, unsigned& across) {
+        along = compact(static_cast<std::uint32_t>(p));
+        across = compact(static_cast<std::uint32_t>(p >> 1));
+    }
+};
+
+// Each plane cut into B x B tiles stored contiguously, so a box sweep stays
+// within a few tiles' cache lines in both directions. Tiles follow the
+// plane's wires (a wire crosses consecutive tiles); inside a tile, cells are
+// in Order. Planes are padded to whole tiles.
+template<int B, typename Order = LinearTileOrder>
+class TiledLayout : public GridExtent {
+    static_assert(B >= 2 && B <= 256 && (B & (B - 1)) == 0, "tile size must be a power of two up to 256");
+    static constexpr int kShift = B == 2 ? 1 : B == 4 ? 2 : B == 8 ? 3 : B == 16 ? 4 : B == 32 ? 5
+                                : B == 64 ? 6 : B == 128 ? 7 : 8;
+
+    std::size_t vtiles_ = 0, htiles_ = 0;  // tiles along each plane's wires
+    std::size_t vsz_ = 0, hsz_ = 0;
+
+    static std::size_t tiles(std::size_t n) { return (n + B - 1) / B; }
+
+    inline std::size_t plane_idx(unsigned along, unsigned across, std::size_t tiles_along) const {
+        auto tile = (across >> kShift) * tiles_along + (along >> kShift);
+        return (tile << (2 * kShift)) | Order::pos(along & (B - 1), across & (B - 1), kShift);
+    }
+    inline void plane_rp(std::size_t i, std::size_t tiles_along, unsigned& along, unsigned& across) const {
+        auto tile = i >> (2 * kShift);
+        Order::unpos(i & ((std::size_t(1) << (2 * kShift)) - 1), kShift, along, across);
+        along |= static_cast<unsigned>((tile % tiles_along) << kShift);
+        across |= static_cast<unsigned>((tile / tiles_along) << kShift);
+    }
+
+protected:
+    void reset(std::size_t width, std::size_t height) {
+        reset_extent(width, height);
+        vtiles_ = tiles(h_ - 1);
+        htiles_ = tiles(w_ - 1);
+        vsz_ = vtiles_ * tiles(w_) * B * B;
+        hsz_ = htiles_ * tiles(h_) * B * B;
+    }
+
+public:
+    static constexpr const char* name = B == 8 ? "tiled8" : B == 16 ? "tiled16" : "tiled";
+
+    std::size_t num_slots() const { return vsz_ + hsz_; }
+    std::size_t hori_begin() const { return vsz_; }
+
+    inline std::size_t rp2idx(int x, int y, bool hori) const {
+        auto ux = static_cast<unsigned>(x), uy = static_cast<unsigned>(y);
+        if (hori) return vsz_ + plane_idx(ux, uy, htiles_);
+        return plane_idx(uy, ux, vtiles_);
+    }
+
+    // The across bits of a slot are fixed along a line; only the tile and
+    // in-tile along bits change.
+    struct Line {
+        std::size_t base;
+        std::size_t operator()(int along) const {
+            auto a = static_cast<unsigned>(along);
+            return base + (static_cast<std::size_t>(a >> kShift) << (2 * kShift)) +
+                   Order::pos(a & (B - 1), 0, kShift);
+        }
+    };
+    Line line(bool hori, int across) const {
+        auto c = static_cast<unsigned>(across);
+        auto tile_row = (c >> kShift) * (hori ? htiles_ : vtiles_);
+        return {(hori ? vsz_ : 0) + (tile_row << (2 * kShift)) + Order::pos(0, c & (B - 1), kShift)};
+    }
+
+    // Inverse of rp2idx (padding slots map outside the grid).
+    inline void idx2rp(std::size_t i, int& x, int& y, bool& hori) const {
+        unsigned along, across;
+        hori = i >= vsz_;
+        if (hori) {
+            plane_rp(i - vsz_, htiles_, along, across);
+            x = static_cast<int>(along);
+            y = static_cast<int>(across);
+        } else {
+            plane_rp(i, vtiles_, along, across);
+            x = static_cast<int>(across);
+            y = static_cast<int>(along);
+        }
+    }
+};
+
+// Z-order inside 64 x 64 tiles; whole tiles bound the padding on non-square grids.
+class MortonLayout : public TiledLayout<64, ZTileOrder> {
+public:
+    static constexpr const char* name = "morton";
+};
+
+#if defined(VLSIGR_GRID_LAYOUT_TILED8)
+using GridLayout = TiledLayout<8>;
+#elif defined(VLSIGR_GRID_LAYOUT_TILED16)
+using GridLayout = TiledLayout<16>;
+#elif defined(VLSIGR_GRID_LAYOUT_MORTON)
+using GridLayout = MortonLayout;
+#else
+using GridLayout = WireLayout;
+#endif
+
+// Coordinate access policies for the grid containers. CheckedAccess throws
+// std::out_of_range for an edge outside the grid; UncheckedAccess indexes
+// directly and only asserts, so release (NDEBUG) builds pay nothing. Inputs
+// are validated where they enter (parser, ECO delta, checkpoint), which is
+// why the routing grids default to UncheckedAccess.
+struct CheckedAccess {
+    [[noreturn, gnu::cold, gnu::noinline]] static void out_of_range() {
+        throw std::out_of_range("grid edge out of range");
+    }
+    static void check(bool inside) {
+        if (!inside) out_of_range();
+    }
+};
+
+struct UncheckedAccess {
+    static void check([[maybe_unused]] bool inside) { assert(inside && "grid edge out of range"); }
+};
+
+// One straight wire of a grid container: row y of horizontal edges indexed
+// by x, or column x of vertical edges indexed by y. Hot loops walk it without
+// recomputing rp2idx per step; with WireLayout it is a plain pointer walk.
+template<typename T, typename Line>
+class EdgeLine {
+    T* data_;
+    Line line_;
+
+public:
+    EdgeLine(T* data, Line line) : data_(data), line_(line) {}
+    T& operator[](int along) const { return data_[line_(along)]; }
+};
+
+template<typename T, typename Layout = GridLayout, typename Access = UncheckedAccess>
+class GridGraph : public Layout {
+    std::vector<T> edges_;
+
+    using Line = typename Layout::Line;
+
+public:
+    std::size_t size()   const { return edges_.size(); }
+
     const T& at(int x, int y, bool hori) const {
-        return edges_.at(rp2idx(x, y, hori));
+        Access::check(this->contains(x, y, hori));
+        return edges_[this->rp2idx(x, y, hori)];
     }
     T& at(int x, int y, bool hori) {
-        return edges_.at(rp2idx(x, y, hori));
+        Access::check(this->contains(x, y, hori));
+        return edges_[this->rp2idx(x, y, hori)];
+    }
+
+    // Horizontal edges of row y / vertical edges of column x.
+    EdgeLine<const T, Line> row(int y) const {
+        Access::check(y >= 0 && static_cast<std::size_t>(y) < this->height());
+        return {edges_.data(), this->line(true, y)};
+    }
+    EdgeLine<T, Line> row(int y) {
+        Access::check(y >= 0 && static_cast<std::size_t>(y) < this->height());
+        return {edges_.data(), this->line(true, y)};
+    }
+    EdgeLine<const T, Line> col(int x) const {
+        Access::check(x >= 0 && static_cast<std::size_t>(x) < this->width());
+        return {edges_.data(), this->line(false, x)};
     }
+    EdgeLine<T, Line> col(int x) {
+        Access::check(x >= 0 && static_cast<std::size_t>(x) < this->width());
+        return {edges_.data(), this->line(false, x)};
+    }
+
+    const T& operator[](std::size_t i) const { return edges_[i]; }
+    T& operator[](std::size_t i) { return edges_[i]; }
 
     void init(std::size_t width, std::size_t height, const T& vInit, const T& hInit) {
-        w_ = width; h_ = height;
-        vsz_ = w_ * (h_ - 1);
-        hsz_ = (w_ - 1) * h_;
+        this->reset(width, height);
         edges_.clear();
-        edges_.reserve(vsz_ + hsz_);
-        edges_.insert(edges_.end(), vsz_, vInit);
-        edges_.insert(edges_.end(), hsz_, hInit);
+        edges_.reserve(this->num_slots());
+        edges_.insert(edges_.end(), this->hori_begin(), vInit);
+        edges_.insert(edges_.end(), this->num_slots() - this->hori_begin(), hInit);
     }
 
     auto begin() { return edges_.begin(); }
@@ -45,6 +305,3 @@ public:
 };
 
 }  // namespace vlsigr
-
-
-
@@ -2,11 +2,11 @@
 
 #include <algorithm>
 #include <cmath>
-#include <optional>
-#include <vector>
 #include <array>
-#include <immintrin.h>  // for target("avx2") annotation
+#include <vector>
 
+#include "router/box_cost.hpp"
+#include "router/min_plus.hpp"
 #include "router/patterns.hpp"
 #include "router/utils.hpp"
 
@@ -14,163 +14,92 @@ namespace vlsigr::hum {
 
 namespace {
 
-#if defined(__GNUC__)
-#define SIMD_AVX2 __attribute__((target("avx2")))
-#else
-#define SIMD_AVX2
-#endif
-
 inline int delta_from_reroute(int cnt) {
     if (cnt <= 2) return 5;
     if (cnt <= 6) return 20;
     return 15;
 }
 
-struct Box {
-    bool eL, eR, eB, eU;
-    int L, R, B, U;
-    Box(Point f, Point t)
-        : eL(true), eR(true), eB(true), eU(true),
-          L(std::min(f.x, t.x)), R(std::max(f.x, t.x)),
-          B(std::min(f.y, t.y)), U(std::max(f.y, t.y)) {}
-    std::size_t width() const { return (std::size_t)(R - L + 1); }
-    std::size_t height() const { return (std::size_t)(U - B + 1); }
-    Point BL() const { return Point(L, B, 0); }
-    Point UR() const { return Point(R, U, 0); }
-};
-
-struct BoxCost : Box {
-    struct Data {
-        double cost = INFINITY;
-        std::optional<Point> from = std::nullopt;
-    };
-    std::vector<Data> cost;
-    explicit BoxCost(const Box& box)
-        : Box(box), cost(box.width() * box.height()) {}
-    
-    Data& operator()(Point p) { return operator()(p.x, p.y); }
-    Data& operator()(int x, int y) {
-        auto i = (std::size_t)(x - L);
-        auto j = (std::size_t)(y - B);
-        return cost.at(i * height() + j);
-    }
-    
-    void trace(std::vector<RPoint>& path, Point pp) {
-        auto size = path.size() + width() * height();
-        while (true) {
-            auto ocp = operator()(pp).from;
-            if (path.size() > size) break;  // safety guard
-            if (!ocp.has_value()) break;
-            auto cp = ocp.value();
-            // make RPoint from pp to cp
-            auto dx = std::abs(pp.x - cp.x);
-            auto dy = std::abs(pp.y - cp.y);
-            if (dx + dy != 1) break;  // invalid path
-            if (dx == 1)
-                path.emplace_back(std::min(pp.x, cp.x), pp.y, 0, true);
-            else
-                path.emplace_back(pp.x, std::min(pp.y, cp.y), 0, false);
-            pp = cp;
-        }
-    }
-};
+BoxCost box_cost(const SearchBox& box, BoxScratch& scratch, BoxCost::Order order) {
+    return BoxCost(box.L, box.R, box.B, box.U, scratch, order);
+}
 
-// Use cached edge.cost, do not recompute here
-inline double edge_cost(CostModel& /* cm */, GridGraph<Edge>& grid, int x, int y, bool hori) {
-    return grid.at(x, y, hori).cost;  // Use cached cost, do NOT calc_cost!
+// Edge costs of one run, gathered for the line kernels (min_plus.hpp), per thread.
+std::vector<EdgeCost>& run_costs() {
+    thread_local std::vector<EdgeCost> costs;
+    return costs;
 }
 
-SIMD_AVX2 inline void calcX(BoxCost& box, int y, int bx, int ex,
-                            CostModel& cm, GridGraph<Edge>& grid) {
-    auto dx = sign(ex - bx);
-    if (dx == 0) return;
-    auto pc = box(bx, y).cost;
-    // SIMD-friendly linear scan; avoid branches to help vectorization
-    #pragma GCC ivdep
-    for (auto px = bx, x = px + dx; x != ex + dx; px = x, x += dx) {
-        auto cc = pc + edge_cost(cm, grid, std::min(x, px), y, true);
-        auto& data = box(x, y);
-        if (data.cost <= cc) {
-            pc = data.cost;
-        } else {
-            pc = cc;
-            data.cost = cc;
-            data.from = Point(px, y, 0);
-        }
-    }
+// Sweep row y both ways over its horizontal edges. box is kByRow.
+template<typename Grid>
+void calcX(BoxCost& box, int y, const SearchBox& sb, const Grid& grid) {
+    auto n = static_cast<int>(sb.width());
+    auto& g = run_costs();
+    g.resize(sb.width());
+    auto row = grid.row_cost(y);  // cached costs, no calc_cost here
+    for (int i = 0; i + 1 < n; i++) g[i] = row[sb.L + i];
+    auto first = box.index(sb.L, y);
+    relax_run(box, first, n, g.data(), false, BoxCost::kLeft);
+    relax_run(box, first, n, g.data(), true, BoxCost::kRight);
 }
 
-SIMD_AVX2 inline void calcY(BoxCost& box, int x, int by, int ey,
-                            CostModel& cm, GridGraph<Edge>& grid) {
-    auto dy = sign(ey - by);
-    if (dy == 0) return;
-    auto pc = box(x, by).cost;
-    // SIMD-friendly linear scan; avoid branches to help vectorization
-    #pragma GCC ivdep
-    for (auto py = by, y = py + dy; y != ey + dy; py = y, y += dy) {
-        auto cc = pc + edge_cost(cm, grid, x, std::min(y, py), false);
-        auto& data = box(x, y);
-        if (data.cost <= cc) {
-            pc = data.cost;
-        } else {
-            pc = cc;
-            data.cost = cc;
-            data.from = Point(x, py, 0);
-        }
-    }
+// Sweep column x both ways over its vertical edges. box is kByColumn.
+template<typename Grid>
+void calcY(BoxCost& box, int x, const SearchBox& sb, const Grid& grid) {
+    auto n = static_cast<int>(sb.height());
+    auto& g = run_costs();
+    g.resize(sb.height());
+    auto col = grid.col_cost(x);
+    for (int i = 0; i + 1 < n; i++) g[i] = col[sb.B + i];
+    auto first = box.index(x, sb.B);
+    relax_run(box, first, n, g.data(), false, BoxCost::kDown);
+    relax_run(box, first, n, g.data(), true, BoxCost::kUp);
 }
 
-void VMR_impl(Point f, Point t, BoxCost& box, CostModel& cm, GridGraph<Edge>& grid) {
-    box(f).cost = 0;
-    box(f).from = std::nullopt;
-    calcX(box, f.y, box.L, box.R, cm, grid);
-    calcX(box, f.y, box.R, box.L, cm, grid);
+// VMR over a kByRow box: rows from f.y towards t.y, each reached straight
+// from the previous one and then swept.
+template<typename Grid>
+void VMR_impl(Point f, Point t, const SearchBox& sb, BoxCost& box, const Grid& grid) {
+    box.cost(f.x, f.y) = 0;
+    calcX(box, f.y, sb, grid);
     auto dy = sign(t.y - f.y);
+    auto from = dy > 0 ? BoxCost::kDown : BoxCost::kUp;
+    auto n = static_cast<int>(sb.width());
     for (auto py = f.y, y = py + dy; y != t.y + dy; py = y, y += dy) {
-        // Hint compiler to vectorize inner loop
-        #pragma GCC ivdep
-        for (auto x = box.L; x <= box.R; x++) {
-            box(x, y).cost = box(x, py).cost + edge_cost(cm, grid, x, std::min(y, py), false);
-            box(x, y).from = Point(x, py, 0);
-        }
-        calcX(box, y, box.L, box.R, cm, grid);
-        calcX(box, y, box.R, box.L, cm, grid);
+        auto& g = run_costs();
+        g.resize(sb.width());
+        for (int i = 0; i < n; i++) g[i] = grid.cost(sb.L + i, std::min(y, py), false);
+        extend_run(box, box.index(sb.L, y), box.index(sb.L, py), n, g.data(), from);
+        calcX(box, y, sb, grid);
     }
 }
 
-void HMR_impl(Point f, Point t, BoxCost& box, CostModel& cm, GridGraph<Edge>& grid) {
-    box(f).cost = 0;
-    box(f).from = std::nullopt;
-    calcY(box, f.x, box.B, box.U, cm, grid);
-    calcY(box, f.x, box.U, box.B, cm, grid);
+// HMR over a kByColumn box, column by column.
+template<typename Grid>
+void HMR_impl(Point f, Point t, const SearchBox& sb, BoxCost& box, const Grid& grid) {
+    box.cost(f.x, f.y) = 0;
+    calcY(box, f.x, sb, grid);
     auto dx = sign(t.x - f.x);
+    auto from = dx > 0 ? BoxCost::kLeft : BoxCost::kRight;
+    auto n = static_cast<int>(sb.height());
     for (auto px = f.x, x = px + dx; x != t.x + dx; px = x, x += dx) {
-        // Hint compiler to vectorize inner loop
-        #pragma GCC ivdep
-        for (auto y = box.B; y <= box.U; y++) {
-            box(x, y).cost = box(px, y).cost + edge_cost(cm, grid, std::min(x, px), y, true);
-            box(x, y).from = Point(px, y, 0);
-        }
-        calcY(box, x, box.B, box.U, cm, grid);
-        calcY(box, x, box.U, box.B, cm, grid);
+        auto& g = run_costs();
+        g.resize(sb.height());
+        for (int i = 0; i < n; i++) g[i] = grid.cost(std::min(x, px), sb.B + i, true);
+        extend_run(box, box.index(x, sb.B), box.index(px, sb.B), n, g.data(), from);
+        calcY(box, x, sb, grid);
     }
 }
 
 }  // namespace
 
-void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, std::size_t height) {
-    bool insert = false;
-    if (tp.box == nullptr) {
-        insert = true;
-        tp.box = new Box(tp.from, tp.to);
-    }
-    auto& box = *(Box*)tp.box;
-
-    // Congestion-aware bounding box expansion
-    if (insert || true) {  // always expand (legacy behavior)
+template<typename Grid>
+void HUM(TwoPin& tp, SearchBox& box, const Grid& grid, CostModel& /* cm */, std::size_t width, std::size_t height) {
+    // Congestion-aware bounding box expansion, every visit
+    {
         std::array<int, 2> CntOE{0, 0};
-        for (auto& rp : tp.path)
-            if (grid.at(rp.x, rp.y, rp.hori).overflow())
+        for (const auto& rp : tp.path)
+            if (grid.overflow(grid.index(rp.x, rp.y, rp.hori)))
                 CntOE[rp.hori]++;
         
         auto d = delta_from_reroute(tp.reroute);
@@ -192,31 +121,35 @@ void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, st
     }
 
     auto f = tp.from, t = tp.to;
-    BoxCost CostVF(box), CostHF(box), CostVT(box), CostHT(box);
+    // Four boxes at once, each over its own per-thread scratch; VMR sweeps
+    // rows, so its boxes keep rows contiguous, HMR's keep columns.
+    thread_local BoxScratch scratch[4];
+    auto CostVF = box_cost(box, scratch[0], BoxCost::kByRow), CostHF = box_cost(box, scratch[1], BoxCost::kByColumn);
+    auto CostVT = box_cost(box, scratch[2], BoxCost::kByRow), CostHT = box_cost(box, scratch[3], BoxCost::kByColumn);
     
     // Sequential for serial version (lines 589-603)
     if (std::abs(f.x - t.x) == (box.R - box.L)) {
-        VMR_impl(f, box.BL(), CostVF, cm, grid); VMR_impl(f, box.UR(), CostVF, cm, grid);
-        VMR_impl(t, box.BL(), CostVT, cm, grid); VMR_impl(t, box.UR(), CostVT, cm, grid);
+        VMR_impl(f, box.BL(), box, CostVF, grid); VMR_impl(f, box.UR(), box, CostVF, grid);
+        VMR_impl(t, box.BL(), box, CostVT, grid); VMR_impl(t, box.UR(), box, CostVT, grid);
     } else if (std::abs(f.y - t.y) == (box.U - box.B)) {
-        HMR_impl(f, box.BL(), CostHF, cm, grid); HMR_impl(f, box.UR(), CostHF, cm, grid);
-        HMR_impl(t, box.BL(), CostHT, cm, grid); HMR_impl(t, box.UR(), CostHT, cm, grid);
+        HMR_impl(f, box.BL(), box, CostHF, grid); HMR_impl(f, box.UR(), box, CostHF, grid);
+        HMR_impl(t, box.BL(), box, CostHT, grid); HMR_impl(t, box.UR(), box, CostHT, grid);
     } else {
-        VMR_impl(f, box.BL(), CostVF, cm, grid); VMR_impl(f, box.UR(), CostVF, cm, grid);
-        HMR_impl(f, box.BL(), CostHF, cm, grid); HMR_impl(f, box.UR(), CostHF, cm, grid);
-        VMR_impl(t, box.BL(), CostVT, cm, grid); VMR_impl(t, box.UR(), CostVT, cm, grid);
-        HMR_impl(t, box.BL(), CostHT, cm, grid); HMR_impl(t, box.UR(), CostHT, cm, grid);
+        VMR_impl(f, box.BL(), box, CostVF, grid); VMR_impl(f, box.UR(), box, CostVF, grid);
+        HMR_impl(f, box.BL(), box, CostHF, grid); HMR_impl(f, box.UR(), box, CostHF, grid);
+        VMR_impl(t, box.BL(), box, CostVT, grid); VMR_impl(t, box.UR(), box, CostVT, grid);
+        HMR_impl(t, box.BL(), box, CostHT, grid); HMR_impl(t, box.UR(), box, CostHT, grid);
     }
     
     // lines 604-612
     auto cF = [&](int x, int y) {
-        return std::min(CostVF(x, y).cost, CostHF(x, y).cost);
+        return std::min(CostVF.cost(x, y), CostHF.cost(x, y));
     };
     auto cT = [&](int x, int y) {
-        return std::min(CostVT(x, y).cost, CostHT(x, y).cost);
+        return std::min(CostVT.cost(x, y), CostHT.cost(x, y));
     };
     auto calc = [&](int x, int y) {
-        return cF(x, y) + cT(x, y);
+        return cost_add(cF(x, y), cT(x, y));
     };
     
     // lines 651-662: sequential minimum search
@@ -236,15 +169,15 @@ void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, st
     // lines 663-670
     tp.path.clear();
     Point m(mx, my, 0);
-    auto trace = [&](BoxCost& CostV, BoxCost& CostH) {
-        auto& cost = (CostV(mx, my).cost < CostH(mx, my).cost) ? CostV : CostH;
-        cost.trace(tp.path, m);
+    auto trace = [&](BoxCost& CostV, BoxCost& CostH, Point source) {
+        auto& cost = (CostV.cost(mx, my) < CostH.cost(mx, my)) ? CostV : CostH;
+        cost.trace(tp.path, m, source);
     };
-    trace(CostVF, CostHF);
-    trace(CostVT, CostHT);
+    trace(CostVF, CostHF, f);
+    trace(CostVT, CostHT, t);
 
-    // lines 672-703: boundary update
-    constexpr double alpha = 1;
+    // lines 672-703: boundary update (alpha per unit of distance, in grid cost units)
+    constexpr EdgeCost alpha = kCostScale;
     auto update = [&](int L, int R, int B, int U) {
         auto ec = calc(L, B);
         for (int ux = L; ux <= R; ux++) 
@@ -252,7 +185,7 @@ void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, st
                 for (int vx = L; vx <= R; vx++) 
                     for (int vy = B; vy <= U; vy++) {
                         auto d = std::abs(ux - vx) + std::abs(uy - vy);
-                        auto c = cF(ux, uy) + cT(vx, vy) + d * alpha;
+                        auto c = cost_add(cost_add(cF(ux, uy), cT(vx, vy)), d * alpha);
                         if (c < ec) ec = c;
                     }
         return mc >= ec;
@@ -264,4 +197,9 @@ void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, st
     box.eU = update(box.L, box.R, box.U, box.U);
 }
 
+template void HUM(TwoPin&, SearchBox&, const BasicSoAGridGraph<WireLayout>&, CostModel&, std::size_t, std::size_t);
+template void HUM(TwoPin&, SearchBox&, const BasicSoAGridGraph<TiledLayout<8>>&, CostModel&, std::size_t, std::size_t);
+template void HUM(TwoPin&, SearchBox&, const BasicSoAGridGraph<TiledLayout<16>>&, CostModel&, std::size_t, std::size_t);
+template void HUM(TwoPin&, SearchBox&, const BasicSoAGridGraph<MortonLayout>&, CostModel&, std::size_t, std::size_t);
+
 }  // namespace vlsigr::hum
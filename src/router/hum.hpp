@@ -1,17 +1,37 @@
 #pragma once
 
 // HUM-specific logic: bounding box expansion, cost grids, VMR/HMR sweeps.
+#include <algorithm>
 #include <cstddef>
 
 #include "router/ispd_data.hpp"
-#include "router/grid_graph.hpp"
 #include "router/cost_model.hpp"
+#include "router/soa_grid_graph.hpp"
 
 namespace vlsigr::hum {
 
-// Route a two-pin using a simplified HUM-like box expansion and cost DP.
-// width/height are grid dimensions.
-void HUM(TwoPin& tp, GridGraph<Edge>& grid, CostModel& cm, std::size_t width, std::size_t height);
+// The search box HUM keeps per two-pin across iterations: current bounds and
+// which sides may still grow. RoutingCore owns one per two-pin.
+struct SearchBox {
+    int L, R, B, U;
+    bool eL, eR, eB, eU;
+
+    // HUM's starting box: tp's bounding box, free to grow on every side.
+    static SearchBox around(const TwoPin& tp) {
+        return {std::min(tp.from.x, tp.to.x), std::max(tp.from.x, tp.to.x),
+                std::min(tp.from.y, tp.to.y), std::max(tp.from.y, tp.to.y), true, true, true, true};
+    }
+    std::size_t width() const { return static_cast<std::size_t>(R - L + 1); }
+    std::size_t height() const { return static_cast<std::size_t>(U - B + 1); }
+    Point BL() const { return Point(L, B, 0); }
+    Point UR() const { return Point(R, U, 0); }
+};
+
+// Route a two-pin using a simplified HUM-like box expansion and cost DP,
+// growing its search box. width/height are grid dimensions. Instantiated for
+// BasicSoAGridGraph over every layout in grid_graph.hpp.
+template<typename Grid>
+void HUM(TwoPin& tp, SearchBox& box, const Grid& grid, CostModel& cm, std::size_t width, std::size_t height);
 
 }  // namespace vlsigr::hum
 
@@ -1,9 +1,16 @@
 #include "ispd_data.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <exception>
+#include <future>
 #include <limits>
 #include <stdexcept>
 
+#include "router/compressed_input.hpp"
+#include "router/mapped_file.hpp"
+#include "router/text_scanner.hpp"
+#include "router/thread_pool.hpp"
+
 namespace vlsigr {
 
 static void expect(bool cond, const char* msg) {
@@ -76,6 +83,8 @@ IspdData parse_ispd(std::istream& is) {
     // origin/tile
     is >> data.lowerLeftX >> data.lowerLeftY >> data.tileWidth >> data.tileHeight;
     expect(is.good(), "failed to read origin/tile size");
+    expect(data.numXGrid > 0 && data.numYGrid > 0 && data.numLayer > 0 && data.tileWidth > 0 &&
+           data.tileHeight > 0, "grid and tile sizes must be positive");
 
     // num net
     is >> keyword >> keyword >> data.numNet;
@@ -87,13 +96,15 @@ IspdData parse_ispd(std::istream& is) {
         Net net;
         is >> net.name >> net.id >> net.numPins >> net.minimumWidth;
         expect(is.good(), "failed to read net header");
-        net.pins.reserve(net.numPins);
+        net.pin_begin = data.pin_coords.size();
         for (int j = 0; j < net.numPins; j++) {
             int x, y, z;
             is >> x >> y >> z;
             expect(is.good(), "failed to read pin");
-            net.pins.emplace_back(x, y, z);
+            expect(data.inside_die(x, y, z), "pin lies outside the die");
+            data.pin_coords.emplace_back(x, y, z);
         }
+        net.pin_count = static_cast<int>(data.pin_coords.size() - net.pin_begin);
         data.nets.emplace_back(std::move(net));
     }
 
@@ -112,12 +123,274 @@ IspdData parse_ispd(std::istream& is) {
     return data;
 }
 
-IspdData parse_ispd_file(const std::string& path) {
-    std::ifstream ifs(path);
-    if (!ifs.is_open()) throw std::runtime_error("failed to open file: " + path);
-    return parse_ispd(ifs);
+namespace {
+
+// Read `n` per-layer integers preceded by a two-word tag whose second word is `tag`.
+void read_layer_values(TextScanner& sc, const char* tag, int n, std::vector<int>& out,
+                       const char* tag_msg, const char* value_msg) {
+    std::string first;
+    expect(sc.read_token(first) && sc.expect_token(tag), tag_msg);
+    out.clear();
+    out.reserve(n > 0 ? n : 0);
+    for (int i = 0; i < n; i++) {
+        int v;
+        expect(sc.read_int(v), value_msg);
+        out.push_back(v);
+    }
+    sc.skip_line();
 }
 
-}  // namespace vlsigr
+void parse_net_header(TextScanner& sc, Net& net) {
+    expect(sc.read_token(net.name) && sc.read_int(net.id) && sc.read_int(net.numPins) &&
+           sc.read_int(net.minimumWidth), "failed to read net header");
+    net.pin_count = std::max(0, net.numPins);
+}
+
+// Pins index the grid unchecked downstream, so one outside the die is rejected here.
+void read_pin(TextScanner& sc, const IspdData& data, int& x, int& y, int& z) {
+    expect(sc.read_int(x) && sc.read_int(y) && sc.read_int(z), "failed to read pin");
+    expect(data.inside_die(x, y, z), "pin lies outside the die");
+}
+
+using HookFutures = std::vector<std::future<void>>;
+
+// Run opt.net_hook over nets [b, e) on a pool worker.
+void submit_net_hook(IspdData& data, Net* nets, std::size_t b, std::size_t e,
+                     const ParseOptions& opt, HookFutures& futs) {
+    futs.emplace_back(thread_pool().enqueue([&data, &opt, nets, b, e] {
+        for (auto i = b; i < e; i++) opt.net_hook(data, nets[i]);
+    }));
+}
+
+// Wait for every hook task, then rethrow the first failure (if any).
+void wait_net_hooks(HookFutures& futs) {
+    std::exception_ptr err;
+    for (auto& f : futs) {
+        try {
+            f.get();
+        } catch (...) {
+            if (!err) err = std::current_exception();
+        }
+    }
+    futs.clear();
+    if (err) std::rethrow_exception(err);
+}
+
+void clear_pins(IspdData& data) {
+    data.pin_coords.clear();
+    data.pin2D_coords.clear();
+    data.pin3D_coords.clear();
+}
+
+// Hooks read and write the pin arrays, so they may only reallocate while no
+// hook task is running: drain, then grow all three together.
+void grow_pins(IspdData& data, std::size_t need, HookFutures& hooks) {
+    wait_net_hooks(hooks);
+    auto cap = std::max(need, data.pin_coords.capacity() * 2);
+    data.pin_coords.reserve(cap);
+    data.pin2D_coords.reserve(cap);
+    data.pin3D_coords.reserve(cap);
+}
 
+void parse_nets_serial(TextScanner& sc, IspdData& data, const ParseOptions& opt) {
+    data.nets.clear();
+    data.nets.reserve(data.numNet > 0 ? data.numNet : 0);
+    clear_pins(data);
+    // Nets never reallocate below numNet, so hook batches can run while parsing continues.
+    Net* base = data.nets.data();
+    const auto batch = static_cast<std::size_t>(std::max(1, opt.nets_per_task));
+    std::size_t handed = 0;
+    HookFutures hooks;
+    auto& pins = data.pin_coords;
+    auto submit = [&] {
+        // Within the capacity reserved by grow_pins, so no reallocation.
+        data.pin2D_coords.resize(pins.size());
+        data.pin3D_coords.resize(pins.size());
+        submit_net_hook(data, base, handed, data.nets.size(), opt, hooks);
+        handed = data.nets.size();
+    };
+    try {
+        if (opt.net_hook) grow_pins(data, 4 * data.nets.capacity(), hooks);
+        for (int i = 0; i < data.numNet; i++) {
+            Net net;
+            parse_net_header(sc, net);
+            net.pin_begin = pins.size();
+            if (opt.net_hook && pins.size() + net.pin_count > pins.capacity())
+                grow_pins(data, pins.size() + net.pin_count, hooks);
+            for (int j = 0; j < net.pin_count; j++) {
+                int x, y, z;
+                read_pin(sc, data, x, y, z);
+                pins.emplace_back(x, y, z);
+            }
+            data.nets.emplace_back(std::move(net));
+            if (opt.net_hook && data.nets.size() - handed >= batch) submit();
+        }
+        if (opt.net_hook && handed < data.nets.size()) submit();
+    } catch (...) {
+        try { wait_net_hooks(hooks); } catch (...) {}
+        throw;
+    }
+    wait_net_hooks(hooks);
+}
+
+// First pass over the net section: record where every net header starts and
+// its pin count. Assumes the usual one-pin-per-line layout; chunk parsing
+// verifies the boundaries, so an unusual layout only costs a serial re-parse.
+bool index_nets(TextScanner sc, int numNet, std::vector<const char*>& starts,
+                std::vector<std::size_t>& pin_begin, const char*& section_end) {
+    starts.resize(static_cast<std::size_t>(numNet) + 1);
+    pin_begin.resize(static_cast<std::size_t>(numNet) + 1);
+    pin_begin[0] = 0;
+    for (int i = 0; i < numNet; i++) {
+        sc.skip_ws();
+        starts[i] = sc.pos();
+        int id, numPins, minWidth;
+        if (!sc.skip_token() || !sc.read_int(id) || !sc.read_int(numPins) || !sc.read_int(minWidth))
+            return false;
+        sc.skip_line();
+        for (int j = 0; j < numPins; j++) {
+            if (sc.at_end()) return false;
+            sc.skip_line();
+        }
+        pin_begin[i + 1] = pin_begin[i] + static_cast<std::size_t>(std::max(0, numPins));
+    }
+    sc.skip_ws();
+    section_end = sc.pos();
+    starts[numNet] = section_end;
+    return true;
+}
+
+// Parse nets [begin, end) into preallocated net and pin slots; false if the
+// chunk disagrees with the index (pin counts or where the next net starts).
+bool parse_net_chunk(const char* buf_end, const std::vector<const char*>& starts,
+                     const std::vector<std::size_t>& pin_begin, std::size_t begin,
+                     std::size_t end, IspdData& data) {
+    TextScanner sc(starts[begin], buf_end);
+    for (auto i = begin; i < end; i++) {
+        auto& net = data.nets[i];
+        parse_net_header(sc, net);
+        net.pin_begin = pin_begin[i];
+        if (pin_begin[i] + net.pin_count != pin_begin[i + 1]) return false;
+        auto* out = data.pin_coords.data() + net.pin_begin;
+        for (int j = 0; j < net.pin_count; j++) {
+            int x, y, z;
+            read_pin(sc, data, x, y, z);
+            out[j] = PinCoord{x, y, z};
+        }
+    }
+    sc.skip_ws();
+    return sc.pos() == starts[end];
+}
+
+bool parse_nets_parallel(TextScanner& sc, IspdData& data, const ParseOptions& opt) {
+    std::vector<const char*> starts;
+    std::vector<std::size_t> pin_begin;
+    const char* section_end = nullptr;
+    if (!index_nets(sc, data.numNet, starts, pin_begin, section_end)) return false;
+
+    const auto n = static_cast<std::size_t>(data.numNet);
+    const auto chunk = static_cast<std::size_t>(std::max(1, opt.nets_per_task));
+    data.nets.clear();
+    data.nets.resize(n);
+    // Exact CSR sizes are known from the index, so the pin arrays are allocated once.
+    clear_pins(data);
+    data.pin_coords.resize(pin_begin[n]);
+    if (opt.net_hook) {
+        data.pin2D_coords.resize(pin_begin[n]);
+        data.pin3D_coords.resize(pin_begin[n]);
+    }
 
+    std::vector<std::future<bool>> futs;
+    futs.reserve((n + chunk - 1) / chunk);
+    for (std::size_t b = 0; b < n; b += chunk) {
+        auto e = std::min(n, b + chunk);
+        futs.emplace_back(thread_pool().enqueue([&, b, e] {
+            if (!parse_net_chunk(sc.end(), starts, pin_begin, b, e, data)) return false;
+            if (opt.net_hook)
+                for (auto i = b; i < e; i++) opt.net_hook(data, data.nets[i]);
+            return true;
+        }));
+    }
+    bool ok = true;
+    for (auto& f : futs) {
+        try {
+            ok = f.get() && ok;
+        } catch (...) {
+            ok = false;  // every task must finish first; the serial pass reports the error
+        }
+    }
+    if (!ok) return false;
+    sc.seek(section_end);
+    return true;
+}
+
+IspdData parse_scanned(TextScanner& sc, const ParseOptions& opt) {
+    IspdData data;
+
+    // grid x y layer
+    expect(sc.expect_token("grid") && sc.read_int(data.numXGrid) && sc.read_int(data.numYGrid) &&
+           sc.read_int(data.numLayer), "failed to read grid");
+
+    read_layer_values(sc, "capacity", data.numLayer, data.verticalCapacity,
+                      "failed to read vertical capacity tag", "failed to read vertical capacity");
+    read_layer_values(sc, "capacity", data.numLayer, data.horizontalCapacity,
+                      "failed to read horizontal capacity tag", "failed to read horizontal capacity");
+    read_layer_values(sc, "width", data.numLayer, data.minimumWidth,
+                      "failed to read minimum width tag", "failed to read minimum width");
+    read_layer_values(sc, "spacing", data.numLayer, data.minimumSpacing,
+                      "failed to read minimum spacing tag", "failed to read minimum spacing");
+    read_layer_values(sc, "spacing", data.numLayer, data.viaSpacing,
+                      "failed to read via spacing tag", "failed to read via spacing");
+
+    // origin/tile
+    expect(sc.read_int(data.lowerLeftX) && sc.read_int(data.lowerLeftY) &&
+           sc.read_int(data.tileWidth) && sc.read_int(data.tileHeight), "failed to read origin/tile size");
+    expect(data.numXGrid > 0 && data.numYGrid > 0 && data.numLayer > 0 && data.tileWidth > 0 &&
+           data.tileHeight > 0, "grid and tile sizes must be positive");
+
+    // num net
+    std::string keyword;
+    expect(sc.read_token(keyword) && sc.expect_token("net") && sc.read_int(data.numNet),
+           "failed to read num net");
+
+    // The parallel index needs the whole net section in one contiguous range.
+    bool parallel = !sc.streaming() && opt.parallel_min_nets > 0 && data.numNet >= opt.parallel_min_nets;
+    if (!parallel || !parse_nets_parallel(sc, data, opt))
+        parse_nets_serial(sc, data, opt);
+
+    // capacity adjustments
+    expect(sc.read_int(data.numCapacityAdj), "failed to read num capacity adjustments");
+    data.capacityAdjs.clear();
+    data.capacityAdjs.reserve(data.numCapacityAdj > 0 ? data.numCapacityAdj : 0);
+    for (int i = 0; i < data.numCapacityAdj; i++) {
+        int x1, y1, z1, x2, y2, z2, reduced;
+        expect(sc.read_int(x1) && sc.read_int(y1) && sc.read_int(z1) && sc.read_int(x2) &&
+               sc.read_int(y2) && sc.read_int(z2) && sc.read_int(reduced),
+               "failed to read capacity adjustment");
+        data.capacityAdjs.push_back(CapacityAdj{{x1, y1, z1}, {x2, y2, z2}, reduced});
+    }
+
+    return data;
+}
+
+}  // namespace
+
+IspdData parse_ispd_buffer(const char* buf, std::size_t size, const ParseOptions& opt) {
+    TextScanner sc(buf, buf + size);
+    return parse_scanned(sc, opt);
+}
+
+IspdData parse_ispd_chunks(ChunkSource& src, const ParseOptions& opt) {
+    TextScanner sc(src);
+    return parse_scanned(sc, opt);
+}
+
+IspdData parse_ispd_file(const std::string& path, const ParseOptions& opt) {
+    MappedFile file(path);
+    auto kind = detect_compression(file.data(), file.size());
+    if (kind == Compression::None) return parse_ispd_buffer(file.data(), file.size(), opt);
+    DecompressingSource src(file.data(), file.size(), kind);
+    return parse_ispd_chunks(src, opt);
+}
+
+}  // namespace vlsigr
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <istream>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include "router/segment_path.hpp"
+#include "router/span.hpp"
+
 namespace vlsigr {
 
 struct Point {
@@ -13,31 +18,27 @@ struct Point {
     Point(int x_, int y_, int z_ = 0): x(x_), y(y_), z(z_) {}
 };
 
-struct RPoint {
-    int x = 0, y = 0, z = 0;
-    bool hori = false;
-    RPoint() = default;
-    RPoint(int x_, int y_, bool h): x(x_), y(y_), z(0), hori(h) {}
-    RPoint(int x_, int y_, int z_, bool h): x(x_), y(y_), z(z_), hori(h) {}
-};
-
 struct TwoPin {
     Point from, to;
-    std::vector<RPoint> path;
+    SegmentPath path;   // 2D route
     int reroute = 0;   // track how many times this twopin has been rerouted
     bool overflow = false;
     bool ripup = false;
-    void* box = nullptr; // optional HUM bounding box storage
+    int id = -1;       // index into the router's per-two-pin state; -1 until RoutingCore wraps it
 };
 
+using PinCoord = std::tuple<int, int, int>;
+
 struct Net {
     std::string name;
     int id = 0;
     int numPins = 0;
     int minimumWidth = 0;
-    std::vector<std::tuple<int, int, int>> pins;
-    std::vector<Point> pin2D;
-    std::vector<Point> pin3D;
+    // Pins live in the owning IspdData's CSR store (IspdData::pins/pin2D/pin3D).
+    std::size_t pin_begin = 0;
+    int pin_count = 0;
+    int pin2D_count = 0;
+    int pin3D_count = 0;
     std::vector<TwoPin> twopin;
 
     // stats
@@ -72,15 +73,76 @@ struct IspdData {
     int numNet = 0;
     std::vector<Net> nets;
 
+    // Design-wide CSR pin store. A net's raw pins are
+    // pin_coords[pin_begin, pin_begin + pin_count); its projected tile pins use
+    // the same offset in pin2D_coords/pin3D_coords (projection deduplicates, so
+    // they always fit in the raw run). Prefer the accessors below.
+    std::vector<PinCoord> pin_coords;
+    std::vector<Point> pin2D_coords;
+    std::vector<Point> pin3D_coords;
+
+    Span<const PinCoord> pins(const Net& net) const {
+        return {pin_coords.data() + net.pin_begin, static_cast<std::size_t>(net.pin_count)};
+    }
+    Span<Point> pin2D(const Net& net) {
+        return {pin2D_coords.data() + net.pin_begin, static_cast<std::size_t>(net.pin2D_count)};
+    }
+    Span<const Point> pin2D(const Net& net) const {
+        return {pin2D_coords.data() + net.pin_begin, static_cast<std::size_t>(net.pin2D_count)};
+    }
+    Span<Point> pin3D(const Net& net) {
+        return {pin3D_coords.data() + net.pin_begin, static_cast<std::size_t>(net.pin3D_count)};
+    }
+    Span<const Point> pin3D(const Net& net) const {
+        return {pin3D_coords.data() + net.pin_begin, static_cast<std::size_t>(net.pin3D_count)};
+    }
+
+    // Whether a raw pin (die coordinates, 1-based layer) lies inside the die.
+    bool inside_die(int x, int y, int z) const {
+        return x >= lowerLeftX && x < lowerLeftX + static_cast<long long>(numXGrid) * tileWidth &&
+               y >= lowerLeftY && y < lowerLeftY + static_cast<long long>(numYGrid) * tileHeight &&
+               z >= 1 && z <= numLayer;
+    }
+
     int numCapacityAdj = 0;
     std::vector<CapacityAdj> capacityAdjs;
+
+    // True once nets carry pin2D/pin3D and twopin (see prepare_nets).
+    bool decomposed = false;
 };
 
 // Parse ISPD 2008 format from stream; throws std::runtime_error on malformed input.
 IspdData parse_ispd(std::istream& is);
 
-// Convenience helper to load from file path.
-IspdData parse_ispd_file(const std::string& path);
+struct ParseOptions {
+    // Parse the "num net" section on vlsigr::thread_pool() workers once the design
+    // has at least this many nets; 0 keeps parsing serial. Net order always matches
+    // the serial parser. Do not call a parallel parse from inside a pool task.
+    int parallel_min_nets = 65536;
+    int nets_per_task = 8192;
+
+    // Optional per-net stage run on pool workers while parsing continues (batches
+    // of nets_per_task). Header fields of the IspdData are complete when it runs
+    // and the pin arrays are sized to cover the net; the hook may only touch the
+    // net it is handed and that net's pin slots. All hooks finish before the
+    // parse returns.
+    std::function<void(IspdData&, Net&)> net_hook;
+};
+
+// Parse ISPD 2008 format from an in-memory buffer (mmapped file, Python bytes, ...).
+// Produces the same IspdData as parse_ispd without going through iostreams.
+IspdData parse_ispd_buffer(const char* data, std::size_t size, const ParseOptions& opt = {});
+
+class ChunkSource;
+
+// Parse from a sequence of blocks (see text_scanner.hpp). Nets are always
+// parsed serially here; opt.net_hook still runs on pool workers.
+IspdData parse_ispd_chunks(ChunkSource& src, const ParseOptions& opt = {});
+
+// Convenience helper to load from file path (mmap + parse_ispd_buffer).
+// gzip/zstd files are recognized by their magic bytes and decompressed on a
+// background thread while parsing (see compressed_input.hpp).
+IspdData parse_ispd_file(const std::string& path, const ParseOptions& opt = {});
 
 }  // namespace vlsigr
 
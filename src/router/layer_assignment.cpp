@@ -1,10 +1,16 @@
 #include "layer_assignment.hpp"
 
+#include <algorithm>
+#include <deque>
+#include <future>
 #include <memory>
 #include <iostream>
+#include <thread>
 
 #include "../../third_party/LayerAssignment.h"
 #include "../../third_party/ispdData.h"
+#include "router/result_file.hpp"
+#include "router/thread_pool.hpp"
 
 namespace vlsigr {
 
@@ -37,11 +43,14 @@ std::unique_ptr<ISPDParser::ispdData> to_legacy(const IspdData& d) {
     // nets
     for (auto& n : d.nets) {
         auto* net = new ISPDParser::Net(n.name, n.id, n.numPins, n.minimumWidth);
-        net->pins = n.pins;
-        net->pin2D.reserve(n.pin2D.size());
-        for (auto& p : n.pin2D) net->pin2D.emplace_back(p.x, p.y, p.z);
-        net->pin3D.reserve(n.pin3D.size());
-        for (auto& p : n.pin3D) net->pin3D.emplace_back(p.x, p.y, p.z);
+        auto pins = d.pins(n);
+        net->pins.assign(pins.begin(), pins.end());
+        auto pin2D = d.pin2D(n);
+        net->pin2D.reserve(pin2D.size());
+        for (auto& p : pin2D) net->pin2D.emplace_back(p.x, p.y, p.z);
+        auto pin3D = d.pin3D(n);
+        net->pin3D.reserve(pin3D.size());
+        for (auto& p : pin3D) net->pin3D.emplace_back(p.x, p.y, p.z);
         net->twopin.reserve(n.twopin.size());
         for (auto& tp : n.twopin) {
             ISPDParser::TwoPin ltp;
@@ -52,7 +61,7 @@ std::unique_ptr<ISPDParser::ispdData> to_legacy(const IspdData& d) {
             ltp.overflow = tp.overflow;
             ltp.ripup = tp.ripup;
             // Copy path before push_back (TwoPin copy ctor doesn't copy path!)
-            for (auto& rp : tp.path) {
+            for (const auto& rp : tp.path) {
                 ltp.path.emplace_back(rp.x, rp.y, rp.z, rp.hori);
             }
             net->twopin.push_back(ltp);
@@ -64,11 +73,65 @@ std::unique_ptr<ISPDParser::ispdData> to_legacy(const IspdData& d) {
     return legacy;
 }
 
+// Collect the layer-assigned wires and vias of every net (chunks of nets on
+// the pool) and stream them, in net order, into a binary result file.
+void write_binary_result(const LayerAssignment::Graph& graph, const IspdData& data, const std::string& path) {
+    const int n = static_cast<int>(graph.netArray.size());
+    const int chunk = std::max(1024, n / 64);
+    auto collect = [&graph, n, chunk](int b) {
+        ResultChunk out;
+        std::vector<LayerAssignment::Line> lines, tmp;
+        std::vector<LayerAssignment::Via3D> vias;
+        std::vector<std::vector<int>> tmpInfo(graph.xNum, std::vector<int>(graph.yNum, -1));
+        for (int i = b, e = std::min(n, b + chunk); i < e; i++) {
+            const auto& net = graph.netArray[i];
+            out.add_net(net.name, net.netID);
+            graph.get3Dresult(i, lines, vias, tmp, tmpInfo);
+            for (auto& l : lines) {
+                if (l.hori) out.add_segment({l.x, l.y, l.x + l.len, l.y, l.z});
+                else out.add_segment({l.x, l.y, l.x, l.y + l.len, l.z});
+            }
+            for (auto& v : vias) out.add_via({v.x, v.y, v.minLay, v.maxLay});
+        }
+        return out;
+    };
+
+    ResultHeader grid{};
+    grid.num_x_grid = data.numXGrid;
+    grid.num_y_grid = data.numYGrid;
+    grid.num_layer = data.numLayer;
+    grid.lower_left_x = data.lowerLeftX;
+    grid.lower_left_y = data.lowerLeftY;
+    grid.tile_width = data.tileWidth;
+    grid.tile_height = data.tileHeight;
+    ResultWriter out(path, grid, n);
+
+    // The same window as Graph::output3Dresult: two chunks per worker.
+    const std::size_t window = 2 * std::max(1u, std::thread::hardware_concurrency());
+    std::deque<std::future<ResultChunk>> parts;
+    int next = 0;
+    try {
+        while (next < n || !parts.empty()) {
+            for (; next < n && parts.size() < window; next += chunk)
+                parts.emplace_back(thread_pool().enqueue(collect, next));
+            auto part = parts.front().get();
+            parts.pop_front();
+            out.append(part);
+        }
+    } catch (...) {
+        // collect reads graph: let queued chunks finish first.
+        for (auto& f : parts) f.wait();
+        throw;
+    }
+    out.finish();
+}
+
 }  // namespace
 
 LayerAssignmentResult run_layer_assignment(IspdData& data,
                                            const std::string& output_path,
-                                           bool print_to_screen) {
+                                           bool print_to_screen,
+                                           const std::string& result_path) {
     auto legacy = to_legacy(data);
     
     // Debug: check twopin path conversion
@@ -90,7 +153,10 @@ LayerAssignmentResult run_layer_assignment(IspdData& data,
     graph.convertGRtoLA(*legacy, print_to_screen);
     graph.COLA(print_to_screen);
     if (!output_path.empty()) {
-        graph.output3Dresult(output_path.c_str());
+        graph.output3Dresult(output_path.c_str(), &thread_pool());
+    }
+    if (!result_path.empty()) {
+        write_binary_result(graph, data, result_path);
     }
     LayerAssignmentResult res;
     res.totalOF = graph.totalOF;
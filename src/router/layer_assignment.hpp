@@ -18,10 +18,12 @@ struct LayerAssignmentResult {
 };
 
 // Run 3D layer assignment using third_party LayerAssignment.
-// output_path empty -> skip file emission.
+// output_path empty -> skip text emission; result_path non-empty -> also write
+// the binary routed-result file (router/result_file.hpp).
 LayerAssignmentResult run_layer_assignment(IspdData& data,
                                            const std::string& output_path,
-                                           bool print_to_screen);
+                                           bool print_to_screen,
+                                           const std::string& result_path = {});
 
 }  // namespace vlsigr
 
@@ -0,0 +1,76 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace vlsigr {
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("failed to open file: " + path);
+
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+            map_ = p;
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<std::size_t>(st.st_size);
+            ::close(fd);
+            return;
+        }
+    }
+
+    // Fallback: slurp with read().
+    char chunk[1 << 16];
+    while (true) {
+        auto n = ::read(fd, chunk, sizeof(chunk));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            throw std::runtime_error("failed to read file: " + path);
+        }
+        if (n == 0) break;
+        buffer_.insert(buffer_.end(), chunk, chunk + n);
+    }
+    ::close(fd);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    map_ = std::exchange(other.map_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    buffer_ = std::move(other.buffer_);
+    data_ = map_ ? static_cast<const char*>(map_) : buffer_.data();
+    other.data_ = nullptr;
+    return *this;
+}
+
+void MappedFile::release() {
+    if (map_) ::munmap(map_, size_);
+    map_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+}
+
+}  // namespace vlsigr
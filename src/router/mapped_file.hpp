@@ -0,0 +1,37 @@
+#pragma once
+
+// Read-only view of a whole file: mmap when possible, plain read() otherwise
+// (pipes, special files, platforms without mmap).
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace vlsigr {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    // Throws std::runtime_error if the file cannot be opened or read.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool mapped() const { return map_ != nullptr; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    void* map_ = nullptr;        // non-null when backed by mmap
+    std::vector<char> buffer_;   // fallback storage
+
+    void release();
+};
+
+}  // namespace vlsigr
@@ -0,0 +1,158 @@
+#include "min_plus.hpp"
+
+#include "router/simd.hpp"
+
+#if defined(VLSIGR_AVX2) && defined(VLSIGR_COST_FIXED)
+#define VLSIGR_MIN_PLUS_AVX2 1
+#endif
+
+namespace vlsigr {
+
+namespace {
+
+// Mask of the low n (< 8) cells of a block, or all 8.
+unsigned block_mask(int n) { return n >= 8 ? 0xFFu : (1u << n) - 1; }
+
+// Ascending sweep over cells [lo, n) of c, cell lo - 1 already final.
+void relax_up(BoxCost& box, std::size_t first, int lo, int n, const EdgeCost* g, BoxCost::From d) {
+    EdgeCost* c = box.cost_data() + first;
+    auto pc = c[lo - 1];
+    for (int i = lo; i < n; i++) {
+        auto cc = cost_add(pc, g[i - 1]);
+        if (c[i] <= cc) {
+            pc = c[i];
+        } else {
+            pc = c[i] = cc;
+            box.set_from8(first + i, 1, d);
+        }
+    }
+}
+
+// Descending sweep over cells [0, hi) of c, cell hi already final.
+void relax_down(BoxCost& box, std::size_t first, int hi, const EdgeCost* g, BoxCost::From d) {
+    EdgeCost* c = box.cost_data() + first;
+    auto pc = c[hi];
+    for (int i = hi - 1; i >= 0; i--) {
+        auto cc = cost_add(pc, g[i]);
+        if (c[i] <= cc) {
+            pc = c[i];
+        } else {
+            pc = c[i] = cc;
+            box.set_from8(first + i, 1, d);
+        }
+    }
+}
+
+#ifdef VLSIGR_MIN_PLUS_AVX2
+// Lanes moved up by S, the low S lanes taken from fill.
+template<int S>
+__attribute__((target("avx2")))
+inline __m256i shift_up(__m256i v, __m256i fill) {
+    const __m256i idx = _mm256_setr_epi32(0, 1 - S, 2 - S, 3 - S, 4 - S, 5 - S, 6 - S, 7 - S);
+    return _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, _mm256_max_epi32(idx, _mm256_setzero_si256())),
+                              fill, (1 << S) - 1);
+}
+
+// Lane l of (a, b) maps v to min(a, v + b); fold in the lanes S below it.
+template<int S>
+__attribute__((target("avx2")))
+inline void compose(__m256i& a, __m256i& b) {
+    a = _mm256_min_epi32(a, sat_add(shift_up<S>(a, _mm256_set1_epi32(kCostInf)), b));
+    b = sat_add(shift_up<S>(b, _mm256_setzero_si256()), b);
+}
+
+// Eight cells in sweep order: out[l] = min(c[l], out[l - 1] + w[l]), with
+// out[-1] = carry (broadcast). Saturating min-plus is associative, so the
+// log-step scan matches the sequential sweep exactly.
+__attribute__((target("avx2")))
+inline __m256i scan8(__m256i c, __m256i w, __m256i carry) {
+    __m256i a = c, b = w;
+    compose<1>(a, b);
+    compose<2>(a, b);
+    compose<4>(a, b);
+    return _mm256_min_epi32(a, sat_add(carry, b));
+}
+
+__attribute__((target("avx2")))
+void relax_run_avx2(BoxCost& box, std::size_t first, int n, const EdgeCost* g, bool descending, BoxCost::From d) {
+    EdgeCost* c = box.cost_data() + first;
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    if (!descending) {
+        int lo = 1;
+        __m256i carry = _mm256_set1_epi32(c[0]);
+        for (; lo + 8 <= n; lo += 8) {
+            __m256i old = load8(c + lo);
+            __m256i out = scan8(old, load8(g + lo - 1), carry);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + lo), out);
+            if (auto m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(old, out))))
+                box.set_from8(first + lo, static_cast<unsigned>(m), d);
+            carry = _mm256_permutevar8x32_epi32(out, _mm256_set1_epi32(7));
+        }
+        relax_up(box, first, lo, n, g, d);
+    } else {
+        int hi = n - 1;
+        __m256i carry = _mm256_set1_epi32(c[hi]);
+        for (; hi >= 8; hi -= 8) {
+            // Cells hi - 8 .. hi - 1, reversed into sweep order and back.
+            __m256i old = load8(c + hi - 8);
+            __m256i out = _mm256_permutevar8x32_epi32(
+                scan8(_mm256_permutevar8x32_epi32(old, reverse),
+                      _mm256_permutevar8x32_epi32(load8(g + hi - 8), reverse), carry),
+                reverse);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + hi - 8), out);
+            if (auto m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(old, out))))
+                box.set_from8(first + hi - 8, static_cast<unsigned>(m), d);
+            carry = _mm256_permutevar8x32_epi32(out, _mm256_setzero_si256());
+        }
+        relax_down(box, first, hi, g, d);
+    }
+    _mm256_zeroupper();
+}
+
+__attribute__((target("avx2")))
+void extend_run_avx2(BoxCost& box, std::size_t first, std::size_t prev, int n, const EdgeCost* g,
+                     BoxCost::From d) {
+    EdgeCost* c = box.cost_data();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + first + i), sat_add(load8(c + prev + i), load8(g + i)));
+        box.set_from8(first + i, 0xFF, d);
+    }
+    for (int j = i; j < n; j++) c[first + j] = cost_add(c[prev + j], g[j]);
+    if (i < n) box.set_from8(first + i, block_mask(n - i), d);
+    _mm256_zeroupper();
+}
+#endif
+
+}  // namespace
+
+void relax_run_scalar(BoxCost& box, std::size_t first, int n, const EdgeCost* g, bool descending, BoxCost::From d) {
+    if (n < 2) return;
+    if (descending)
+        relax_down(box, first, n - 1, g, d);
+    else
+        relax_up(box, first, 1, n, g, d);
+}
+
+void extend_run_scalar(BoxCost& box, std::size_t first, std::size_t prev, int n, const EdgeCost* g,
+                       BoxCost::From d) {
+    EdgeCost* c = box.cost_data();
+    for (int i = 0; i < n; i++) c[first + i] = cost_add(c[prev + i], g[i]);
+    for (int i = 0; i < n; i += 8) box.set_from8(first + i, block_mask(n - i), d);
+}
+
+void relax_run(BoxCost& box, std::size_t first, int n, const EdgeCost* g, bool descending, BoxCost::From d) {
+#ifdef VLSIGR_MIN_PLUS_AVX2
+    if (n >= 9 && have_avx2()) return relax_run_avx2(box, first, n, g, descending, d);
+#endif
+    relax_run_scalar(box, first, n, g, descending, d);
+}
+
+void extend_run(BoxCost& box, std::size_t first, std::size_t prev, int n, const EdgeCost* g, BoxCost::From d) {
+#ifdef VLSIGR_MIN_PLUS_AVX2
+    if (n >= 8 && have_avx2()) return extend_run_avx2(box, first, prev, n, g, d);
+#endif
+    extend_run_scalar(box, first, prev, n, g, d);
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,32 @@
+#pragma once
+
+// Min-plus line kernels for the box searches (HUM's VMR/HMR sweeps): one run
+// of adjacent BoxCost cells at a time, i.e. a row of a kByRow box or a column
+// of a kByColumn box, with the run's edge costs gathered into an array. With
+// CostType=fixed on an AVX2 machine they take 8 cells per step with
+// saturating int32 adds (relax_run as a log-step scan); otherwise they are
+// the scalar loops. Both give the same costs and predecessors.
+
+#include <cstddef>
+
+#include "router/box_cost.hpp"
+#include "router/edge_cost.hpp"
+
+namespace vlsigr {
+
+// Relax the n cells from index first in place along the run, as a sweep:
+// ascending, cell i from cell i - 1 over g[i - 1]; descending, cell i from
+// cell i + 1 over g[i] (g holds the run's n - 1 edges). A cell whose cost
+// drops records d as its predecessor; ties keep the old one.
+void relax_run(BoxCost& box, std::size_t first, int n, const EdgeCost* g, bool descending, BoxCost::From d);
+
+// Reach each of the n cells from index first at the cost of cell prev + i
+// plus g[i], recording d.
+void extend_run(BoxCost& box, std::size_t first, std::size_t prev, int n, const EdgeCost* g, BoxCost::From d);
+
+// The scalar loops in every build, for tests and benchmarks.
+void relax_run_scalar(BoxCost& box, std::size_t first, int n, const EdgeCost* g, bool descending, BoxCost::From d);
+void extend_run_scalar(BoxCost& box, std::size_t first, std::size_t prev, int n, const EdgeCost* g,
+                       BoxCost::From d);
+
+}  // namespace vlsigr
@@ -2,107 +2,134 @@
 
 #include <algorithm>
 #include <cmath>
-#include <optional>
+#include <cstdint>
 #include <vector>
 
+#include "router/box_cost.hpp"
+#include "router/simd.hpp"
 #include "router/utils.hpp"
 
 namespace vlsigr::patterns {
 
 namespace {
 
-struct Box {
-    int L, R, B, U;
-    Box(Point f, Point t)
-        : L(std::min(f.x, t.x)), R(std::max(f.x, t.x)),
-          B(std::min(f.y, t.y)), U(std::max(f.y, t.y)) {}
+// Scratch for the boxes a pattern holds at once (Zshape: two), per thread.
+BoxScratch& scratch(int k) {
+    thread_local BoxScratch boxes[2];
+    return boxes[k];
+}
+
+// The bounding box of f and t over scratch k, with f reached at cost 0.
+BoxCost box_around(Point f, Point t, int k) {
+    BoxCost box(std::min(f.x, t.x), std::max(f.x, t.x), std::min(f.y, t.y), std::max(f.y, t.y), scratch(k));
+    box.cost(f.x, f.y) = 0;
+    return box;
+}
+
+// Cost accessors the routers are instantiated with: a caller's cost_fn, unit
+// cost when it is empty, or the grid's costs read inline.
+struct UnitCost {
+    EdgeCost operator()(int, int, bool) const { return kCostScale; }
 };
 
-struct BoxCost : Box {
-    struct Data {
-        double cost = INFINITY;
-        std::optional<Point> from = std::nullopt;
-    };
-    std::vector<Data> cost;
-    explicit BoxCost(const Box& box)
-        : Box(box), cost((size_t)(R - L + 1) * (size_t)(U - B + 1)) {}
-    Data& operator()(int x, int y) {
-        auto i = (size_t)(x - L);
-        auto j = (size_t)(y - B);
-        return cost.at(i * (size_t)(U - B + 1) + j);
-    }
-    void trace(std::vector<RPoint>& path, Point p) {
-        while (true) {
-            auto& d = operator()(p.x, p.y);
-            if (!d.from.has_value()) break;
-            auto prev = d.from.value();
-            // emit edge from prev -> p
-            auto dx = std::abs(prev.x - p.x);
-            auto dy = std::abs(prev.y - p.y);
-            if (dx + dy != 1) break;  // safety
-            if (dx == 1)
-                path.emplace_back(std::min(prev.x, p.x), prev.y, true);
-            else
-                path.emplace_back(prev.x, std::min(prev.y, p.y), false);
-            p = prev;
-        }
-    }
+struct GridCost {
+    const SoAGridGraph& grid;
+    EdgeCost operator()(int x, int y, bool hori) const { return grid.cost(x, y, hori); }
 };
 
-inline double edge_cost(const std::function<double(int,int,bool)>& fn, int x, int y, bool hori) {
-    return fn ? fn(x, y, hori) : 1.0;
+template<typename Route>
+void with_cost_fn(const CostFn& cost_fn, Route&& route) {
+    if (cost_fn)
+        route(cost_fn);
+    else
+        route(UnitCost{});
 }
 
-void calcX(BoxCost& box, int y, int bx, int ex, const std::function<double(int,int,bool)>& cost_fn) {
+template<typename Cost>
+void calcX(BoxCost& box, int y, int bx, int ex, const Cost& cost) {
     auto dx = sign(ex - bx);
     if (dx == 0) return;
-    double pc = box(bx, y).cost;
+    auto from = dx > 0 ? BoxCost::kLeft : BoxCost::kRight;
+    EdgeCost pc = box.cost(bx, y);
     for (auto px = bx, x = px + dx; x != ex + dx; px = x, x += dx) {
-        double cc = pc + edge_cost(cost_fn, std::min(x, px), y, true);
-        auto& d = box(x, y);
-        if (d.cost <= cc) {
-            pc = d.cost;
+        EdgeCost cc = cost_add(pc, cost(std::min(x, px), y, true));
+        auto& c = box.cost(x, y);
+        if (c <= cc) {
+            pc = c;
         } else {
             pc = cc;
-            d.cost = cc;
-            d.from = Point(px, y, 0);
+            c = cc;
+            box.set_from(x, y, from);
         }
     }
 }
 
-void calcY(BoxCost& box, int x, int by, int ey, const std::function<double(int,int,bool)>& cost_fn) {
+template<typename Cost>
+void calcY(BoxCost& box, int x, int by, int ey, const Cost& cost) {
     auto dy = sign(ey - by);
     if (dy == 0) return;
-    double pc = box(x, by).cost;
+    auto from = dy > 0 ? BoxCost::kDown : BoxCost::kUp;
+    EdgeCost pc = box.cost(x, by);
     for (auto py = by, y = py + dy; y != ey + dy; py = y, y += dy) {
-        double cc = pc + edge_cost(cost_fn, x, std::min(y, py), false);
-        auto& d = box(x, y);
-        if (d.cost <= cc) {
-            pc = d.cost;
+        EdgeCost cc = cost_add(pc, cost(x, std::min(y, py), false));
+        auto& c = box.cost(x, y);
+        if (c <= cc) {
+            pc = c;
         } else {
             pc = cc;
-            d.cost = cc;
-            d.from = Point(x, py, 0);
+            c = cc;
+            box.set_from(x, y, from);
         }
     }
 }
 
-} // namespace
+// Route tp through bend m: f -> m -> t, one leg per axis.
+void place_L(TwoPin& tp, Point m) {
+    auto f = tp.from;
+    auto t = tp.to;
+    tp.path.clear();
+    auto lineX = [&](int y, int L, int R) {
+        if (L > R) std::swap(L, R);
+        tp.path.append_run(L, y, true, static_cast<unsigned>(R - L));
+    };
+    auto lineY = [&](int x, int B, int U) {
+        if (B > U) std::swap(B, U);
+        tp.path.append_run(x, B, false, static_cast<unsigned>(U - B));
+    };
+    lineX(f.y, f.x, m.x);
+    lineY(m.x, f.y, m.y);
+    lineX(t.y, m.x, t.x);
+    lineY(m.x, m.y, t.y);
+}
+
+// Append the edges walked from along coordinate a to b on a wire, in walking
+// order (what BoxCost::trace emits for a straight stretch).
+void walk(SegmentPath& path, bool hori, int across, int a, int b) {
+    if (a == b) return;
+    bool back = b < a;
+    int first = back ? a - 1 : a;
+    auto n = static_cast<unsigned>(std::abs(b - a));
+    if (hori)
+        path.append_run(first, across, true, n, back);
+    else
+        path.append_run(across, first, false, n, back);
+}
 
-void Lshape(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn) {
+template<typename Cost>
+void Lshape_impl(TwoPin& tp, const Cost& cost) {
     auto f = tp.from;
     auto t = tp.to;
     // choose cheaper of (f.x -> t.x then f.y -> t.y) vs the other turn
     Point m1(f.x, t.y, f.z), m2(t.x, f.y, f.z);
     auto eval = [&](Point m) {
-        double c = 0;
+        EdgeCost c = 0;
         auto lineX = [&](int y, int L, int R) {
             if (L > R) std::swap(L, R);
-            for (int x = L; x < R; x++) c += edge_cost(cost_fn, x, y, true);
+            for (int x = L; x < R; x++) c = cost_add(c, cost(x, y, true));
         };
         auto lineY = [&](int x, int B, int U) {
             if (B > U) std::swap(B, U);
-            for (int y = B; y < U; y++) c += edge_cost(cost_fn, x, y, false);
+            for (int y = B; y < U; y++) c = cost_add(c, cost(x, y, false));
         };
         if (f.x != m.x) lineX(f.y, f.x, m.x);
         if (f.y != m.y) lineY(m.x, f.y, m.y);
@@ -110,80 +137,311 @@ void Lshape(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn) {
         if (m.y != t.y) lineY(m.x, m.y, t.y);
         return c;
     };
-    double c1 = eval(m1), c2 = eval(m2);
-    Point m = (c1 != c2 ? c1 < c2 : randint<int>(0,1)) ? m1 : m2;
-    tp.path.clear();
-    auto lineX = [&](int y, int L, int R) {
-        if (L > R) std::swap(L, R);
-        for (int x = L; x < R; x++) tp.path.emplace_back(x, y, true);
-    };
-    auto lineY = [&](int x, int B, int U) {
-        if (B > U) std::swap(B, U);
-        for (int y = B; y < U; y++) tp.path.emplace_back(x, y, false);
-    };
-    lineX(f.y, f.x, m.x);
-    lineY(m.x, f.y, m.y);
-    lineX(t.y, m.x, t.x);
-    lineY(m.x, m.y, t.y);
+    EdgeCost c1 = eval(m1), c2 = eval(m2);
+    place_L(tp, (c1 != c2 ? c1 < c2 : randint<int>(0,1)) ? m1 : m2);
 }
 
-void Zshape(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn) {
+template<typename Cost>
+void Zshape_impl(TwoPin& tp, const Cost& cost) {
     auto f = tp.from;
     auto t = tp.to;
     if (f.y > t.y) std::swap(f, t);
     if (f.x > t.x) std::swap(f, t);
 
-    BoxCost boxH(Box(f, t));
-    boxH(f.x, f.y).cost = 0.0;
-    boxH(f.x, f.y).from = std::nullopt;
-    auto boxV = boxH;
+    auto boxH = box_around(f, t, 0), boxV = box_around(f, t, 1);
 
     auto dx = sign(t.x - f.x);
     auto dy = sign(t.y - f.y);
 
-    calcX(boxH, f.y, f.x, t.x, cost_fn);
+    calcX(boxH, f.y, f.x, t.x, cost);
     for (auto px = f.x, x = px + dx; x != t.x + dx; px = x, x += dx)
-        calcY(boxH, x, f.y, t.y, cost_fn);
-    calcX(boxH, t.y, f.x, t.x, cost_fn);
+        calcY(boxH, x, f.y, t.y, cost);
+    calcX(boxH, t.y, f.x, t.x, cost);
 
-    calcY(boxV, f.x, f.y, t.y, cost_fn);
+    calcY(boxV, f.x, f.y, t.y, cost);
     for (auto py = f.y, y = py + dy; y != t.y + dy; py = y, y += dy)
-        calcX(boxV, y, f.x, t.x, cost_fn);
-    calcY(boxV, t.x, f.y, t.y, cost_fn);
+        calcX(boxV, y, f.x, t.x, cost);
+    calcY(boxV, t.x, f.y, t.y, cost);
 
-    auto& box = boxV(t.x, t.y).cost < boxH(t.x, t.y).cost ? boxV : boxH;
+    auto& box = boxV.cost(t.x, t.y) < boxH.cost(t.x, t.y) ? boxV : boxH;
     tp.path.clear();
-    box.trace(tp.path, t);
+    box.trace(tp.path, t, f);
+}
+
+// Tie-break for MonotonicWavefront: take the vertical edge into (x, y) if
+// set. A hash bit of the cell, so ties spread like randint's but need no rng.
+inline bool tie_vert(int x, int y) {
+    return ((static_cast<std::uint32_t>(x) * 0x9E3779B1u) ^ (static_cast<std::uint32_t>(y) * 0x85EBCA77u)) >> 31;
 }
 
-void Monotonic(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn) {
+// Tie-break for Monotonic: a coin from rng.
+inline bool tie_random(int, int) { return randint<int>(0, 1) != 0; }
+
+// Monotonic's box DP; tie(x, y) picks the vertical edge into (x, y) when
+// both ways cost the same.
+template<typename Cost, typename Tie>
+void Monotonic_impl(TwoPin& tp, const Cost& cost, const Tie& tie) {
     auto f = tp.from;
     auto t = tp.to;
     if (f.y > t.y) std::swap(f, t);
     if (f.x > t.x) std::swap(f, t);
 
-    BoxCost box(Box(f, t));
-    box(f.x, f.y).cost = 0.0;
-    box(f.x, f.y).from = std::nullopt;
-    calcX(box, f.y, f.x, t.x, cost_fn);
-    calcY(box, f.x, f.y, t.y, cost_fn);
+    auto box = box_around(f, t, 0);
+    calcX(box, f.y, f.x, t.x, cost);
+    calcY(box, f.x, f.y, t.y, cost);
     auto dy = sign(t.y - f.y);
     for (auto py = f.y, y = py + dy; y != t.y + dy; py = y, y += dy) {
         for (auto px = f.x, x = px + 1; x <= t.x; px = x, x++) {
-            double cx = box(x, py).cost + edge_cost(cost_fn, x, std::min(y, py), false);
-            double cy = box(px, y).cost + edge_cost(cost_fn, std::min(x, px), y, true);
-            bool pickX = (cx != cy ? cx < cy : randint<int>(0,1));
-            if (pickX) {
-                box(x, y).cost = cx;
-                box(x, y).from = Point(x, py, 0);
-            } else {
-                box(x, y).cost = cy;
-                box(x, y).from = Point(px, y, 0);
-            }
+            EdgeCost cx = cost_add(box.cost(x, py), cost(x, std::min(y, py), false));
+            EdgeCost cy = cost_add(box.cost(px, y), cost(std::min(x, px), y, true));
+            bool pickX = (cx != cy ? cx < cy : tie(x, y));
+            if (pickX)
+                box.reach(x, y, cx, dy > 0 ? BoxCost::kDown : BoxCost::kUp);
+            else
+                box.reach(x, y, cy, BoxCost::kLeft);
+        }
+    }
+    tp.path.clear();
+    box.trace(tp.path, t, f);
+}
+
+
+// Wavefront Monotonic. Cell (i, j) of the box is (f.x + i, f.y + dy * j);
+// the cells of anti-diagonal d = i + j depend only on diagonal d - 1, so
+// each diagonal is one vector pass. prev/cur hold a diagonal with cell i at
+// slot i + 1 (slot 0 pads i - 1 = -1); hcost/vcost/vert pack each diagonal's
+// cells lo..hi back to back, cell i of diagonal d at start[d] + i.
+constexpr int kWavefrontMin = 48;  // shortest box side worth a wavefront (tuned on pattern_inline_bench)
+
+struct Wavefront {
+    std::vector<EdgeCost> hcost, vcost;  // by diagonal: edge into the cell from i - 1 / from j - 1
+    std::vector<EdgeCost> prev, cur;     // path costs of diagonals d - 1 and d
+    std::vector<std::uint8_t> vert;      // by diagonal: reached from j - 1 (else from i - 1)
+    std::vector<std::size_t> start;      // per diagonal: its first slot minus its lo
+};
+
+// Cells [begin, end) of diagonal d; a = via j - 1, b = via i - 1.
+void wavefront_scalar(const EdgeCost* prev, const EdgeCost* hcost, const EdgeCost* vcost, EdgeCost* cur,
+                      std::uint8_t* vert, int x0, int yd, int dy, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        EdgeCost a = cost_add(prev[i + 1], vcost[i + 1]);
+        EdgeCost b = cost_add(prev[i], hcost[i + 1]);
+        bool v = a != b ? a < b : tie_vert(x0 + i, yd - dy * i);
+        cur[i + 1] = v ? a : b;
+        vert[i + 1] = v;
+    }
+}
+
+#ifdef VLSIGR_AVX2
+// tie_vert for lanes i, i + 1, ... as all-ones / zero 32-bit masks.
+__attribute__((target("avx2")))
+inline __m256i tie_mask(int x, int y, int dy) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), lane);
+    __m256i ys = _mm256_sub_epi32(_mm256_set1_epi32(y), _mm256_mullo_epi32(_mm256_set1_epi32(dy), lane));
+    __m256i h = _mm256_xor_si256(_mm256_mullo_epi32(xs, _mm256_set1_epi32(static_cast<int>(0x9E3779B1u))),
+                                 _mm256_mullo_epi32(ys, _mm256_set1_epi32(static_cast<int>(0x85EBCA77u))));
+    return _mm256_srai_epi32(h, 31);
+}
+
+// wavefront_scalar, a vector of cells per step with the same adds and
+// compares, so both pick identically.
+__attribute__((target("avx2")))
+void wavefront_avx2(const EdgeCost* prev, const EdgeCost* hcost, const EdgeCost* vcost, EdgeCost* cur,
+                    std::uint8_t* vert, int x0, int yd, int dy, int begin, int end) {
+    int i = begin;
+#ifdef VLSIGR_COST_FIXED
+    for (; i + 8 <= end; i += 8) {
+        __m256i a = sat_add(load8(prev + i + 1), load8(vcost + i + 1));
+        __m256i b = sat_add(load8(prev + i), load8(hcost + i + 1));
+        __m256i tie = _mm256_and_si256(_mm256_cmpeq_epi32(a, b), tie_mask(x0 + i, yd - dy * i, dy));
+        __m256i v = _mm256_or_si256(_mm256_cmpgt_epi32(b, a), tie);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(cur + i + 1), _mm256_blendv_epi8(b, a, v));
+        auto m = _mm256_movemask_ps(_mm256_castsi256_ps(v));
+        for (int l = 0; l < 8; l++) vert[i + 1 + l] = (m >> l) & 1;
+    }
+#else
+    for (; i + 4 <= end; i += 4) {
+        __m256d a = _mm256_add_pd(_mm256_loadu_pd(prev + i + 1), _mm256_loadu_pd(vcost + i + 1));
+        __m256d b = _mm256_add_pd(_mm256_loadu_pd(prev + i), _mm256_loadu_pd(hcost + i + 1));
+        __m256d tie = _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ),
+                                    _mm256_castsi256_pd(_mm256_cvtepi32_epi64(
+                                        _mm256_castsi256_si128(tie_mask(x0 + i, yd - dy * i, dy)))));
+        __m256d v = _mm256_or_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), tie);
+        _mm256_storeu_pd(cur + i + 1, _mm256_blendv_pd(b, a, v));
+        auto m = _mm256_movemask_pd(v);
+        for (int l = 0; l < 4; l++) vert[i + 1 + l] = (m >> l) & 1;
+    }
+#endif
+    wavefront_scalar(prev, hcost, vcost, cur, vert, x0, yd, dy, i, end);
+    _mm256_zeroupper();
+}
+#endif
+
+} // namespace
+
+void Lshape(TwoPin& tp, const CostFn& cost_fn) {
+    with_cost_fn(cost_fn, [&](const auto& cost) { Lshape_impl(tp, cost); });
+}
+
+void Lshape(TwoPin& tp, const SoAGridGraph& grid) { Lshape_impl(tp, GridCost{grid}); }
+
+void Lshape(TwoPin& tp, const CostPrefix& costs) {
+    auto f = tp.from;
+    auto t = tp.to;
+    Point m1(f.x, t.y, f.z), m2(t.x, f.y, f.z);
+    EdgeCost c1 = cost_add(costs.run(false, f.x, f.y, t.y), costs.run(true, t.y, f.x, t.x));
+    EdgeCost c2 = cost_add(costs.run(true, f.y, f.x, t.x), costs.run(false, t.x, f.y, t.y));
+    place_L(tp, (c1 != c2 ? c1 < c2 : randint<int>(0,1)) ? m1 : m2);
+}
+
+void Zshape(TwoPin& tp, const CostFn& cost_fn) {
+    with_cost_fn(cost_fn, [&](const auto& cost) { Zshape_impl(tp, cost); });
+}
+
+void Zshape(TwoPin& tp, const SoAGridGraph& grid) { Zshape_impl(tp, GridCost{grid}); }
+
+void Zshape(TwoPin& tp, const CostPrefix& costs) {
+    auto f = tp.from;
+    auto t = tp.to;
+    if (f.y > t.y) std::swap(f, t);
+    if (f.x > t.x) std::swap(f, t);
+
+    // The bends the box DP reaches: horizontal-vertical-horizontal through
+    // column x in (f.x, t.x], vertical-horizontal-vertical through row y past
+    // f.y up to t.y. Ties go to the bend nearest t, and to HVH between the two.
+    // The two outer legs are running sums along the end wires, so each bend
+    // costs one range query.
+    auto dy = sign(t.y - f.y);
+    EdgeCost costH = kCostInf, costV = kCostInf;
+    int bx = f.x, by = f.y;
+    CostSum head = 0, tail = costs.sum(true, t.y, f.x, t.x);
+    for (auto x = f.x + 1; x <= t.x; x++) {
+        head += costs.edge(true, f.y, x - 1);
+        tail -= costs.edge(true, t.y, x - 1);
+        auto c = cost_add(cost_add(clamp_cost(head), costs.run(false, x, f.y, t.y)), clamp_cost(tail));
+        if (c <= costH) costH = c, bx = x;
+    }
+    head = 0, tail = costs.sum(false, t.x, f.y, t.y);
+    for (auto y = f.y; y != t.y;) {
+        auto e = std::min(y, y + dy);
+        y += dy;
+        head += costs.edge(false, f.x, e);
+        tail -= costs.edge(false, t.x, e);
+        auto c = cost_add(cost_add(clamp_cost(head), costs.run(true, y, f.x, t.x)), clamp_cost(tail));
+        if (c <= costV) costV = c, by = y;
+    }
+
+    // Emitted from t back to f, as BoxCost::trace does.
+    tp.path.clear();
+    if (by != f.y && (bx == f.x || costV < costH)) {
+        walk(tp.path, false, t.x, t.y, by);
+        walk(tp.path, true, by, t.x, f.x);
+        walk(tp.path, false, f.x, by, f.y);
+    } else if (bx != f.x) {
+        walk(tp.path, true, t.y, t.x, bx);
+        walk(tp.path, false, bx, t.y, f.y);
+        walk(tp.path, true, f.y, bx, f.x);
+    }
+}
+
+void Monotonic(TwoPin& tp, const CostFn& cost_fn) {
+    with_cost_fn(cost_fn, [&](const auto& cost) { Monotonic_impl(tp, cost, tie_random); });
+}
+
+void Monotonic(TwoPin& tp, const SoAGridGraph& grid) { Monotonic_impl(tp, GridCost{grid}, tie_random); }
+
+void MonotonicWavefront(TwoPin& tp, const SoAGridGraph& grid) {
+    auto f = tp.from;
+    auto t = tp.to;
+    if (f.y > t.y) std::swap(f, t);
+    if (f.x > t.x) std::swap(f, t);
+    auto dy = t.y < f.y ? -1 : 1;
+    const int w = t.x - f.x + 1, h = std::abs(t.y - f.y) + 1, diags = w + h - 1;
+    // Short diagonals do not pay for skewing the costs: the row-by-row DP
+    // with the same tie-break finds the same path.
+    if (std::min(w, h) < kWavefrontMin) {
+        Monotonic_impl(tp, GridCost{grid}, tie_vert);
+        return;
+    }
+    const auto stride = static_cast<std::size_t>(w) + 1;
+    auto lo_of = [&](int d) { return std::max(0, d - (h - 1)); };
+    auto hi_of = [&](int d) { return std::min(d, w - 1); };
+    auto y_at = [&](int j) { return f.y + dy * j; };
+
+    thread_local Wavefront wf;
+    const auto cells = static_cast<std::size_t>(w) * h;
+    if (wf.hcost.size() < cells) {
+        wf.hcost.resize(cells);
+        wf.vcost.resize(cells);
+        wf.vert.resize(cells);
+    }
+    if (wf.prev.size() < stride) {
+        wf.prev.resize(stride);
+        wf.cur.resize(stride);
+    }
+    wf.start.resize(diags);
+    std::size_t first = 0;
+    for (int d = 0; d < diags; d++) {
+        wf.start[d] = first - lo_of(d);
+        first += hi_of(d) - lo_of(d) + 1;
+    }
+    auto at = [&](int i, int j) { return wf.start[i + j] + i; };
+    // Skew the box's edge costs into diagonal order (rows and columns are
+    // read in order, the diagonals written strided).
+    for (int j = 0; j < h; j++) {
+        auto row = grid.row_cost(y_at(j));
+        for (int i = 1; i < w; i++) wf.hcost[at(i, j)] = row[f.x + i - 1];
+    }
+    for (int i = 0; i < w; i++) {
+        auto col = grid.col_cost(f.x + i);
+        for (int j = 1; j < h; j++) wf.vcost[at(i, j)] = col[std::min(y_at(j), y_at(j - 1))];
+    }
+
+    EdgeCost* prev = wf.prev.data();
+    EdgeCost* cur = wf.cur.data();
+    prev[1] = 0;
+    for (int d = 1; d < diags; d++) {
+        int lo = lo_of(d), hi = hi_of(d);
+        // Biased so that hc[i + 1] is cell i, as in prev/cur (start[d] >= 1 for d >= 1).
+        const EdgeCost* hc = wf.hcost.data() + wf.start[d] - 1;
+        const EdgeCost* vc = wf.vcost.data() + wf.start[d] - 1;
+        std::uint8_t* vert = wf.vert.data() + wf.start[d] - 1;
+        // Cells on the box's first row / column have one way in; the kernel
+        // runs over the rest.
+        int begin = lo, end = hi + 1;
+        if (lo == 0) {
+            cur[1] = cost_add(prev[1], vc[1]);
+            vert[1] = 1;
+            begin = 1;
+        }
+        if (hi == d) {
+            cur[d + 1] = cost_add(prev[d], hc[d + 1]);
+            vert[d + 1] = 0;
+            end = d;
         }
+        if (begin < end) {
+#ifdef VLSIGR_AVX2
+            if (have_avx2())
+                wavefront_avx2(prev, hc, vc, cur, vert, f.x, y_at(d), dy, begin, end);
+            else
+#endif
+                wavefront_scalar(prev, hc, vc, cur, vert, f.x, y_at(d), dy, begin, end);
+        }
+        std::swap(prev, cur);
     }
+
+    // Emitted from t back to f, as BoxCost::trace does.
     tp.path.clear();
-    box.trace(tp.path, t);
+    for (int i = w - 1, j = h - 1; i > 0 || j > 0;) {
+        if (wf.vert[at(i, j)]) {
+            tp.path.emplace_back(f.x + i, std::min(y_at(j), y_at(j - 1)), false);
+            j--;
+        } else {
+            tp.path.emplace_back(f.x + i - 1, y_at(j), true);
+            i--;
+        }
+    }
 }
 
 }  // namespace vlsigr::patterns
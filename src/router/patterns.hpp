@@ -2,24 +2,49 @@
 
 // Pattern routing interfaces (L-shape, Z-shape, monotonic).
 // These functions populate TwoPin::path with Manhattan edges (RPoint).
-// Cost-aware variants accept an optional cost functor; if not provided, unit cost is used.
+// Cost-aware variants accept an optional cost functor giving edge costs in
+// grid units (EdgeCost, see edge_cost.hpp); if not provided, unit cost is used.
 
 #pragma once
 
 #include <functional>
 
+#include "router/cost_prefix.hpp"
+#include "router/edge_cost.hpp"
 #include "router/ispd_data.hpp"
+#include "router/soa_grid_graph.hpp"
 
 namespace vlsigr::patterns {
 
+using CostFn = std::function<EdgeCost(int, int, bool)>;
+
 // Compute L-shape path (pick cheaper of the two bends; tie-break randomly via rng).
-void Lshape(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn = {});
+void Lshape(TwoPin& tp, const CostFn& cost_fn = {});
 
 // Compute Z-shape path using dynamic programming over a bounding box.
-void Zshape(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn = {});
+void Zshape(TwoPin& tp, const CostFn& cost_fn = {});
+
+// The same routers over grid's costs, read inline: no std::function call per
+// edge. Same paths as passing a cost_fn that returns grid.cost(x, y, hori).
+void Lshape(TwoPin& tp, const SoAGridGraph& grid);
+void Zshape(TwoPin& tp, const SoAGridGraph& grid);
+void Monotonic(TwoPin& tp, const SoAGridGraph& grid);
+
+// Lshape and Zshape reading whole legs from running cost sums: O(log n) per
+// leg, and Zshape compares every bend without filling a box. Same paths as
+// the cost_fn versions over the same costs whenever the sums agree (always
+// with CostType=fixed).
+void Lshape(TwoPin& tp, const CostPrefix& costs);
+void Zshape(TwoPin& tp, const CostPrefix& costs);
 
 // Monotonic (Manhattan shortest) path with cost tie-breaking.
-void Monotonic(TwoPin& tp, const std::function<double(int,int,bool)>& cost_fn = {});
+void Monotonic(TwoPin& tp, const CostFn& cost_fn = {});
+
+// Monotonic over grid's costs, filled an anti-diagonal at a time (AVX2 when
+// the CPU has it). Same path costs as Monotonic, but equal-cost ties go by a
+// hash of the cell instead of rng, so the path can differ and rng is not
+// drawn from.
+void MonotonicWavefront(TwoPin& tp, const SoAGridGraph& grid);
 
 }  // namespace vlsigr::patterns
 
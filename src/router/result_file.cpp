@@ -0,0 +1,207 @@
+#include "result_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "router/segment_text.hpp"
+
+namespace vlsigr {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'L', 'G', 'R', 'R', 'S', 'L', 'T'};
+constexpr std::uint32_t kVersion = 1;
+
+static_assert(sizeof(ResultHeader) == 80, "ResultHeader layout changed");
+static_assert(sizeof(ResultNet) == 40, "ResultNet layout changed");
+static_assert(sizeof(ResultSegment) == 20, "ResultSegment layout changed");
+static_assert(sizeof(ResultVia) == 16, "ResultVia layout changed");
+
+template<typename T>
+void write_array(FILE* fp, const T* data, std::size_t n, bool& ok) {
+    static_assert(std::is_trivially_copyable_v<T>, "write_array needs a trivially copyable type");
+    if (ok && n) ok = std::fwrite(data, sizeof(T), n, fp) == n;
+}
+
+}  // namespace
+
+void ResultChunk::add_net(const std::string& name, int id) {
+    ResultNet n{};
+    n.id = id;
+    n.name_size = static_cast<std::uint32_t>(name.size());
+    n.name_offset = names.size();
+    n.segment_begin = segments.size();
+    n.via_begin = vias.size();
+    nets.push_back(n);
+    names += name;
+}
+
+void ResultChunk::add_segment(const ResultSegment& s) {
+    segments.push_back(s);
+    nets.back().segment_count++;
+}
+
+void ResultChunk::add_via(const ResultVia& v) {
+    vias.push_back(v);
+    nets.back().via_count++;
+}
+
+ResultWriter::ResultWriter(const std::string& path, const ResultHeader& grid, std::uint64_t num_nets)
+    : path_(path), header_(grid), num_nets_(num_nets) {
+    std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_.version = kVersion;
+    header_.num_nets = header_.num_segments = header_.num_vias = header_.num_name_bytes = 0;
+    fp_ = std::fopen(path.c_str(), "wb");
+    if (!fp_) throw std::runtime_error("failed to open file for writing: " + path);
+    vias_ = std::tmpfile();
+    names_ = std::tmpfile();
+    if (!vias_ || !names_) {
+        close();
+        throw std::runtime_error("failed to create temporary file for: " + path);
+    }
+}
+
+ResultWriter::~ResultWriter() { close(); }
+
+void ResultWriter::close() {
+    for (auto* f : {fp_, vias_, names_})
+        if (f) std::fclose(f);
+    fp_ = vias_ = names_ = nullptr;
+}
+
+void ResultWriter::append(ResultChunk& chunk) {
+    auto& h = header_;
+    if (h.num_nets + chunk.nets.size() > num_nets_) throw std::runtime_error("too many nets for: " + path_);
+    for (auto& n : chunk.nets) {
+        n.segment_begin += h.num_segments;
+        n.via_begin += h.num_vias;
+        n.name_offset += h.num_name_bytes;
+    }
+    // Segments follow the num_nets_ net records, already sized.
+    const std::uint64_t nets_at = sizeof(ResultHeader) + h.num_nets * sizeof(ResultNet);
+    const std::uint64_t segments_at =
+        sizeof(ResultHeader) + num_nets_ * sizeof(ResultNet) + h.num_segments * sizeof(ResultSegment);
+    bool ok = std::fseek(fp_, static_cast<long>(nets_at), SEEK_SET) == 0;
+    write_array(fp_, chunk.nets.data(), chunk.nets.size(), ok);
+    ok = ok && std::fseek(fp_, static_cast<long>(segments_at), SEEK_SET) == 0;
+    write_array(fp_, chunk.segments.data(), chunk.segments.size(), ok);
+    write_array(vias_, chunk.vias.data(), chunk.vias.size(), ok);
+    write_array(names_, chunk.names.data(), chunk.names.size(), ok);
+    if (!ok) throw std::runtime_error("failed to write file: " + path_);
+    h.num_nets += chunk.nets.size();
+    h.num_segments += chunk.segments.size();
+    h.num_vias += chunk.vias.size();
+    h.num_name_bytes += chunk.names.size();
+}
+
+void ResultWriter::finish() {
+    auto& h = header_;
+    if (h.num_nets != num_nets_) throw std::runtime_error("missing nets for: " + path_);
+    const std::uint64_t end =
+        sizeof(ResultHeader) + num_nets_ * sizeof(ResultNet) + h.num_segments * sizeof(ResultSegment);
+    bool ok = std::fseek(fp_, static_cast<long>(end), SEEK_SET) == 0;
+    std::vector<char> buf(std::size_t(1) << 20);
+    for (auto* staged : {vias_, names_}) {
+        ok = ok && std::fseek(staged, 0, SEEK_SET) == 0;
+        while (ok) {
+            auto got = std::fread(buf.data(), 1, buf.size(), staged);
+            write_array(fp_, buf.data(), got, ok);
+            if (got < buf.size()) {
+                ok = ok && !std::ferror(staged);
+                break;
+            }
+        }
+    }
+    ok = ok && std::fseek(fp_, 0, SEEK_SET) == 0;
+    write_array(fp_, &h, 1, ok);
+    ok = (std::fclose(fp_) == 0) && ok;
+    fp_ = nullptr;
+    if (!ok) throw std::runtime_error("failed to write file: " + path_);
+}
+
+void write_result_file(const std::string& path, const ResultHeader& grid, std::vector<ResultChunk>& chunks) {
+    std::uint64_t num_nets = 0;
+    for (auto& c : chunks) num_nets += c.nets.size();
+    ResultWriter out(path, grid, num_nets);
+    for (auto& c : chunks) out.append(c);
+    out.finish();
+}
+
+bool is_result_file(const std::string& path) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    char magic[sizeof(kMagic)];
+    bool ok = std::fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+              std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    std::fclose(fp);
+    return ok;
+}
+
+ResultFile::ResultFile(const std::string& path): file_(path) {
+    auto bad = [&](const char* why) { return std::runtime_error(std::string("result file: ") + why + ": " + path); };
+    if (file_.size() < sizeof(ResultHeader)) throw bad("unexpected end of data");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) throw bad("bad magic");
+    if (header_.version != kVersion) throw bad("unsupported version");
+
+    const auto& h = header_;
+    // Guard the size arithmetic against absurd counts before multiplying.
+    const std::uint64_t limit = file_.size();
+    if (h.num_nets > limit || h.num_segments > limit || h.num_vias > limit || h.num_name_bytes > limit)
+        throw bad("corrupt header");
+    const std::uint64_t expected = sizeof(ResultHeader) + h.num_nets * sizeof(ResultNet) +
+                                   h.num_segments * sizeof(ResultSegment) + h.num_vias * sizeof(ResultVia) +
+                                   h.num_name_bytes;
+    if (expected != file_.size()) throw bad("size mismatch");
+
+    const char* p = file_.data() + sizeof(ResultHeader);
+    nets_ = {reinterpret_cast<const ResultNet*>(p), static_cast<std::size_t>(h.num_nets)};
+    p += h.num_nets * sizeof(ResultNet);
+    segments_ = {reinterpret_cast<const ResultSegment*>(p), static_cast<std::size_t>(h.num_segments)};
+    p += h.num_segments * sizeof(ResultSegment);
+    vias_ = {reinterpret_cast<const ResultVia*>(p), static_cast<std::size_t>(h.num_vias)};
+    p += h.num_vias * sizeof(ResultVia);
+    names_ = p;
+
+    // [begin, begin + count) within total, without the add wrapping.
+    auto out_of = [](std::uint64_t total, std::uint64_t begin, std::uint64_t count) {
+        return begin > total || count > total - begin;
+    };
+    for (auto& n : nets_) {
+        if (out_of(h.num_segments, n.segment_begin, n.segment_count) ||
+            out_of(h.num_vias, n.via_begin, n.via_count) || out_of(h.num_name_bytes, n.name_offset, n.name_size))
+            throw bad("net record out of range");
+    }
+}
+
+void ResultFile::write_text(const std::string& path) const {
+    FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp) throw std::runtime_error("failed to open file for writing: " + path);
+    const auto& h = header_;
+    auto gx = [&](int x) { return x * h.tile_width + h.lower_left_x; };
+    auto gy = [&](int y) { return y * h.tile_height + h.lower_left_y; };
+    std::string out;
+    bool ok = true;
+    for (auto& n : nets_) {
+        out.append(names_ + n.name_offset, n.name_size);
+        out += ' ';
+        append_int(out, n.id);
+        out += '\n';
+        for (auto& s : segments(n))
+            append_segment(out, gx(s.x1), gy(s.y1), s.z + 1, gx(s.x2), gy(s.y2), s.z + 1);
+        for (auto& v : vias(n))
+            append_segment(out, gx(v.x), gy(v.y), v.z1 + 1, gx(v.x), gy(v.y), v.z2 + 1);
+        out += "!\n";
+        if (out.size() >= (std::size_t(1) << 22)) {
+            ok = ok && std::fwrite(out.data(), 1, out.size(), fp) == out.size();
+            out.clear();
+        }
+    }
+    ok = ok && std::fwrite(out.data(), 1, out.size(), fp) == out.size();
+    ok = (std::fclose(fp) == 0) && ok;
+    if (!ok) throw std::runtime_error("failed to write file: " + path);
+}
+
+}  // namespace vlsigr
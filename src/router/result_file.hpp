@@ -0,0 +1,129 @@
+#pragma once
+
+// Compact binary routed-result file: the same wires and vias as the text
+// output.txt, but in grid coordinates and laid out as flat fixed-size arrays
+// so that readers (draw, Python visualization) can mmap it and walk it
+// without parsing. Native-endian, like design snapshots.
+//
+// Layout: ResultHeader | ResultNet[num_nets] | ResultSegment[num_segments] |
+//         ResultVia[num_vias] | net names (num_name_bytes, not NUL-terminated)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "router/mapped_file.hpp"
+#include "router/span.hpp"
+
+namespace vlsigr {
+
+struct ResultHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    // Tile grid: grid (x, y) maps to (lower_left_x + x * tile_width, lower_left_y + y * tile_height).
+    std::int32_t num_x_grid, num_y_grid, num_layer;
+    std::int32_t lower_left_x, lower_left_y, tile_width, tile_height;
+    std::int32_t reserved;
+    std::uint64_t num_nets;
+    std::uint64_t num_segments;
+    std::uint64_t num_vias;
+    std::uint64_t num_name_bytes;
+};
+
+struct ResultNet {
+    std::int32_t id;
+    std::uint32_t name_size;
+    std::uint64_t name_offset;
+    std::uint64_t segment_begin;
+    std::uint64_t via_begin;
+    std::uint32_t segment_count;
+    std::uint32_t via_count;
+};
+
+// Straight wire on layer z (0-based) from (x1, y1) to (x2, y2); x1 == x2 or y1 == y2.
+struct ResultSegment {
+    std::int32_t x1, y1, x2, y2, z;
+};
+
+// Via stack at (x, y) spanning layers [z1, z2] (0-based, z1 < z2).
+struct ResultVia {
+    std::int32_t x, y, z1, z2;
+};
+
+// Nets, wires and vias for a contiguous range of nets. Writers fill chunks
+// independently (segment_begin/via_begin/name_offset relative to the chunk)
+// and write_result_file rebases them.
+struct ResultChunk {
+    std::vector<ResultNet> nets;
+    std::vector<ResultSegment> segments;
+    std::vector<ResultVia> vias;
+    std::string names;
+
+    void add_net(const std::string& name, int id);      // starts a net
+    void add_segment(const ResultSegment& s);           // appends to the last net
+    void add_via(const ResultVia& v);
+};
+
+// Streams chunks into a result file in net order, so a writer only holds
+// the chunks it has in flight. Nets and segments go to their places in the
+// file; vias and names are staged in temporary files until finish().
+// Header fields other than magic/version/counts come from `grid`.
+// Throws std::runtime_error on I/O failure.
+class ResultWriter {
+public:
+    ResultWriter(const std::string& path, const ResultHeader& grid, std::uint64_t num_nets);
+    ~ResultWriter();
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    void append(ResultChunk& chunk);  // rebases chunk in place
+    void finish();                    // all num_nets nets must have been appended
+
+private:
+    void close();  // without checking, for errors and the destructor
+
+    std::string path_;
+    ResultHeader header_{};
+    std::uint64_t num_nets_;
+    std::FILE* fp_ = nullptr;
+    std::FILE* vias_ = nullptr;
+    std::FILE* names_ = nullptr;
+};
+
+// All chunks at once, through ResultWriter.
+void write_result_file(const std::string& path, const ResultHeader& grid, std::vector<ResultChunk>& chunks);
+
+// True if path starts with the result-file magic.
+bool is_result_file(const std::string& path);
+
+// Read-only mmapped view; throws std::runtime_error on a bad magic, version or size.
+class ResultFile {
+public:
+    explicit ResultFile(const std::string& path);
+
+    const ResultHeader& header() const { return header_; }
+    Span<const ResultNet> nets() const { return nets_; }
+    Span<const ResultSegment> segments(const ResultNet& net) const {
+        return {segments_.data() + net.segment_begin, net.segment_count};
+    }
+    Span<const ResultVia> vias(const ResultNet& net) const {
+        return {vias_.data() + net.via_begin, net.via_count};
+    }
+    std::string name(const ResultNet& net) const { return std::string(names_ + net.name_offset, net.name_size); }
+
+    // Write the equivalent text output.txt (for eval2008.pl and other text consumers).
+    void write_text(const std::string& path) const;
+
+private:
+    MappedFile file_;
+    ResultHeader header_{};
+    Span<const ResultNet> nets_;
+    Span<const ResultSegment> segments_;
+    Span<const ResultVia> vias_;
+    const char* names_ = nullptr;
+};
+
+}  // namespace vlsigr
@@ -2,12 +2,15 @@
 
 #include <algorithm>
 #include <numeric>
-#include <queue>
 #include <cmath>
 #include <limits>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <type_traits>
 
+#include "router/decomposition.hpp"
 #include "router/patterns.hpp"
 #include "router/hum.hpp"
 #include "router/utils.hpp"
@@ -31,22 +34,19 @@ RoutingCore::RoutingCore()
     : width_(0), height_(0), min_width_(0), min_spacing_(0), min_net_(0), mx_cap_(0),
       selcost_(0), stop_(false), print_(true), ispdData_(nullptr), cfg_{} {}
 
-// Destructor
-RoutingCore::~RoutingCore() {
-    for (auto net : nets_) delete net;
-}
-
 // ripup
 void RoutingCore::ripup(TwoPinPtr twopin) {
     if (twopin->ripup) return;
     twopin->ripup = true;
     twopin->reroute++;
-    for (auto rp : twopin->path) {
-        auto& e = getEdge(rp);
-        bool zero = (e.used == 1);
-        if (zero) e.demand--;
-        e.used--;
-    }
+    for_each_edge(*twopin, [&](std::size_t e) {
+        bool zero = (grid_.used(e) == 1);
+        if (zero) {
+            grid_.demand(e)--;
+            changed_.insert(e);
+        }
+        grid_.used(e)--;
+    });
 }
 
 // place
@@ -56,84 +56,183 @@ void RoutingCore::place(TwoPinPtr twopin) {
         return;
     }
     twopin->ripup = false;
-    for (auto rp : twopin->path) {
-        auto& e = getEdge(rp);
-        if (twopin->overflow) e.of++;
-        bool zero = (e.used == 0);
-        if (zero) e.demand++;
-        e.used++;
-    }
+    for_each_edge(*twopin, [&](std::size_t e) {
+        if (twopin->overflow) grid_.of(e)++;
+        bool zero = (grid_.used(e) == 0);
+        if (zero) {
+            grid_.demand(e)++;
+            placed_.push_back(static_cast<std::uint32_t>(e));
+        }
+        if (zero || twopin->overflow) changed_.insert(e);
+        grid_.used(e)++;
+    });
 }
 
 // cost inline functions
 inline double RoutingCore::cost(const TwoPinPtr twopin) const {
     double c = 0;
-    for (auto rp : twopin->path)
-        c += cost(rp);
+    for_each_edge(*twopin, [&](std::size_t e) { c += cost_value(grid_.cost(e)); });
     return c;
 }
 
-inline double RoutingCore::cost(Point f, Point t) const {
+inline EdgeCost RoutingCore::cost(Point f, Point t) const {
     auto dx = std::abs(f.x - t.x);
     auto dy = std::abs(f.y - t.y);
     if (dx == 1 && dy == 0)
         return cost(std::min(f.x, t.x), f.y, true);
     if (dx == 0 && dy == 1)
         return cost(f.x, std::min(f.y, t.y), false);
-    return INFINITY;
-}
-
-inline double RoutingCore::cost(RPoint rp) const {
-    return cost(getEdge(rp));
+    return kCostInf;
 }
 
-inline double RoutingCore::cost(int x, int y, bool hori) const {
-    return cost(getEdge(x, y, hori));
+inline EdgeCost RoutingCore::cost(RPoint rp) const {
+    return grid_.cost(edge(rp));
 }
 
-inline double RoutingCore::cost(const Edge& e) const {
-    return e.cost;
+inline EdgeCost RoutingCore::cost(int x, int y, bool hori) const {
+    return grid_.cost(x, y, hori);
 }
 
-// del_cost for net
+// del_cost for net: one pass over the net's distinct edges
 void RoutingCore::del_cost(NetWrapper* net) {
-    for (auto twopin : net->twopins)
-        for (auto rp : twopin->path)
-            getEdge(rp).used++;
-    for (auto twopin : net->twopins)
-        del_cost(twopin);
+    for (auto& ne : net->edges) {
+        grid_.used(ne.e) += ne.uses;
+        set_cost(ne.e, kCostScale);
+    }
 }
 
 // del_cost for twopin
 void RoutingCore::del_cost(TwoPinPtr twopin) {
-    for (auto rp : twopin->path)
-        getEdge(rp).cost = 1;
+    for_each_edge(*twopin, [&](std::size_t e) { set_cost(e, kCostScale); });
 }
 
-// add_cost for net
-void RoutingCore::add_cost(NetWrapper* net) {
-    for (auto twopin : net->twopins)
-        for (auto rp : twopin->path)
-            getEdge(rp).used--;
+// add_cost for net: one pass over the net's distinct edges, picking up the
+// ones its reroutes placed since del_cost(net)
+template<typename Model>
+void RoutingCore::add_cost(NetWrapper* net, const Model& cm) {
+    update_net_edges(net, [&](std::size_t e) {
+        set_cost(e, cm.edge_cost(grid_.demand(e), grid_.cap(e), grid_.he(e)));
+    });
+}
+
+// update_net_edges: merge placed_ into net->edges, take the use counts from
+// Edge::used (clearing it) and drop edges none of the net's two-pins use any
+// more; f runs on every edge kept. The list stays sorted by edge index, so
+// sums over it do not depend on the order the two-pins were rerouted in.
+template<typename F>
+void RoutingCore::update_net_edges(NetWrapper* net, F&& f) {
+    std::sort(placed_.begin(), placed_.end());
+    auto& out = edges_scratch_;
+    out.clear();
+    auto keep = [&](std::uint32_t e) {
+        // An edge ripped up and placed again is in both lists; used is 0 the second time.
+        auto uses = grid_.used(e);
+        if (uses == 0) return;
+        out.push_back({e, static_cast<std::uint32_t>(uses)});
+        grid_.used(e) = 0;
+        f(e);
+    };
+    auto old = net->edges.begin(), old_end = net->edges.end();
+    for (auto e : placed_) {
+        for (; old != old_end && old->e < e; ++old) keep(old->e);
+        keep(e);
+    }
+    for (; old != old_end; ++old) keep(old->e);
+    net->edges.swap(out);
+    placed_.clear();
+}
+
+// collect_net_edges: rebuild net->edges from the paths (new wrappers, checkpoints)
+void RoutingCore::collect_net_edges(NetWrapper* net) {
+    net->edges.clear();
     for (auto twopin : net->twopins)
-        add_cost(twopin);
+        for_each_edge(*twopin, [&](std::size_t e) {
+            if (grid_.used(e)++ == 0) placed_.push_back(static_cast<std::uint32_t>(e));
+        });
+    update_net_edges(net, [](std::size_t) {});
 }
 
 // add_cost for twopin
-void RoutingCore::add_cost(TwoPinPtr twopin) {
-    for (auto rp : twopin->path) {
-        auto& e = getEdge(rp);
-        if (e.used == 0)
-            e.cost = cost_model_.calc_cost(e);
-    }
+template<typename Model>
+void RoutingCore::add_cost(TwoPinPtr twopin, const Model& cm) {
+    for_each_edge(*twopin, [&](std::size_t e) {
+        if (grid_.used(e) == 0)
+            set_cost(e, cm.edge_cost(grid_.demand(e), grid_.cap(e), grid_.he(e)));
+    });
 }
 
-// build_cost
+// build_cost: bring every edge cost up to date for the current model.
+// Only edges whose inputs changed since the last build need it; add_cost
+// keeps the rest current. Switching model parks the current costs in
+// parked_ and takes the new model's parked costs, refreshed on the edges
+// that changed while they were parked; a model never built gets a full build.
 void RoutingCore::build_cost() {
-    cost_model_.build_cost(grid_);
+    auto refresh = [&](const auto& edges) {
+        cost_model_.visit([&](const auto& cm) {
+            for (auto e : edges) grid_.cost(e) = cm.edge_cost(grid_.demand(e), grid_.cap(e), grid_.he(e));
+        });
+    };
+    for (auto& p : parked_) {
+        if (!p.valid) continue;
+        for (auto e : stale_) p.dirty.insert(e);
+        for (auto e : changed_) p.dirty.insert(e);
+    }
+    if (built_selcost_ == selcost_) {
+        refresh(stale_);
+        refresh(changed_);
+    } else {
+        auto& next = parked_[selcost_];
+        if (built_selcost_ >= 0) {
+            auto& prev = parked_[built_selcost_];
+            prev.dirty.clear();
+            for (auto e : stale_) prev.dirty.insert(e);
+            for (auto e : changed_) prev.dirty.insert(e);
+            next.cost.resize(grid_.size());
+            grid_.swap_costs(next.cost);  // next.cost now holds the current model's costs
+            prev.cost.swap(next.cost);
+            prev.valid = true;
+        }
+        if (next.valid)
+            refresh(next.dirty);
+        else
+            cost_model_.build_cost(grid_);
+        next.valid = false;
+        next.dirty.clear();
+        built_selcost_ = selcost_;
+    }
+    stale_.clear();
+}
+
+// sync_prefix: keep prefix_ in step with the costs from here on if fp is
+// Zshape, rebuilt from the grid (which also clears the drift of double
+// updates). Lshape stays on cost_fn: ripup and place walk every path edge
+// anyway, and the per-net tree updates cost more than the legs save. Called
+// after build_cost, at the start of every routing / refine pass.
+void RoutingCore::sync_prefix(FP fp) {
+    prefix_live_ = fp == &RoutingCore::Zshape;
+    if (prefix_live_) prefix_.build(grid_);
+}
+
+// reset_edge_tracking: rebuild the dirty-edge state from the grid (new grid,
+// restored checkpoint); the next build_cost is a full one.
+void RoutingCore::reset_edge_tracking() {
+    changed_.reset(grid_.size());
+    stale_.reset(grid_.size());
+    eco_hot_.reset(grid_.size());
+    overflowed_.clear();
+    for (std::size_t e = 0; e < grid_.size(); e++) {
+        if (grid_.of(e)) changed_.insert(e);
+        else if (grid_.overflow(e)) overflowed_.push_back(static_cast<std::uint32_t>(e));
+    }
+    built_selcost_ = -1;
+    for (auto& p : parked_) {
+        p.valid = false;
+        p.dirty.reset(grid_.size());
+    }
 }
 
 // sort_twopins
+template<typename Policy>
 void RoutingCore::sort_twopins() {
     std::sort(nets_.begin(), nets_.end(), [&](auto a, auto b) {
         auto sa = score(a);
@@ -142,8 +241,8 @@ void RoutingCore::sort_twopins() {
     });
     for (auto net : nets_)
         std::sort(net->twopins.begin(), net->twopins.end(), [&](auto a, auto b) {
-            auto sa = score(a);
-            auto sb = score(b);
+            auto sa = score<Policy>(a);
+            auto sb = score<Policy>(b);
             auto hpwl_a = std::abs(a->from.x - a->to.x) + std::abs(a->from.y - a->to.y);
             auto hpwl_b = std::abs(b->from.x - b->to.x) + std::abs(b->from.y - b->to.y);
             return sa != sb ? sa < sb : hpwl_a < hpwl_b;
@@ -151,17 +250,18 @@ void RoutingCore::sort_twopins() {
 }
 
 // score for twopin
-inline double RoutingCore::score(const TwoPinPtr twopin) const {
-    if (selcost_ == 2)
+template<typename Policy>
+double RoutingCore::score(const TwoPinPtr twopin) const {
+    if constexpr (std::is_same_v<Policy, AggressiveCost>) {
         return 60 * (twopin->overflow ? 1 : 0) + 1 * (int)twopin->path.size();
-    
-    auto dx = 1 + std::abs(twopin->from.x - twopin->to.x);
-    auto dy = 1 + std::abs(twopin->from.y - twopin->to.y);
-    
-    if (selcost_ == 1)
-        return 60 * (twopin->overflow ? 1 : 0) + (dx * dy);
-    
-    return 100.0 / std::max(dx, dy);
+    } else {
+        auto dx = 1 + std::abs(twopin->from.x - twopin->to.x);
+        auto dy = 1 + std::abs(twopin->from.y - twopin->to.y);
+        if constexpr (std::is_same_v<Policy, SteeperCost>)
+            return 60 * (twopin->overflow ? 1 : 0) + (dx * dy);
+        else
+            return 100.0 / std::max(dx, dy);
+    }
 }
 
 // score for net
@@ -181,45 +281,70 @@ inline int RoutingCore::delta(const TwoPinPtr twopin) const {
 int RoutingCore::check_overflow() {
     int mxof = 0, totof = 0;
     
-    for (auto& edge : grid_) {
-        edge.he += edge.of;
-        edge.of = 0;
-        if (edge.overflow()) {
-            auto of = edge.demand - edge.cap;
+    // History and the overflowed set only move on edges place/ripup changed.
+    std::size_t kept = 0;
+    for (auto e : overflowed_)
+        if (!changed_.contains(e)) overflowed_[kept++] = e;
+    overflowed_.resize(kept);
+    for (auto e : changed_) {
+        grid_.he(e) += grid_.of(e);
+        grid_.of(e) = 0;
+        stale_.insert(e);
+        if (grid_.overflow(e)) overflowed_.push_back(e);
+    }
+    changed_.clear();
+    if (!eco_) {
+        for (auto e : overflowed_) {
+            auto of = grid_.demand(e) - grid_.cap(e);
             totof += of;
             if (of > mxof) mxof = of;
         }
     }
     
     int ofnet = 0, oftp = 0, wl = 0;
+    // In ECO mode only the working set's overflowed edges count.
+    std::vector<std::size_t> eco_edges;
     
     for (auto net : nets_) {
-        net->cost = net->wlen = net->overflow = net->overflow_twopin = 0;
-        for (auto twopin : net->twopins) {
+        net->cost = net->overflow = net->overflow_twopin = 0;
+        net->wlen = static_cast<int>(net->edges.size());
+        for (auto& ne : net->edges)
+            if (grid_.overflow(ne.e)) net->overflow++;
+        for (auto twopin : net->twopins)
             twopin->overflow = false;
-            for (auto rp : twopin->path) {
-                auto& e = getEdge(rp);
-                bool zero = (e.used++ == 0);
-                if (zero) net->wlen++;
-                if (e.overflow()) {
-                    twopin->overflow = true;
-                    if (zero) {
-                        net->cost += cost(e);
-                        net->overflow++;
+        if (net->overflow) {
+            // Walk the paths so the cost adds up in path order, as it always has.
+            for (auto twopin : net->twopins) {
+                for_each_edge(*twopin, [&](std::size_t e) {
+                    bool first = (grid_.used(e)++ == 0);
+                    if (grid_.overflow(e)) {
+                        twopin->overflow = true;
+                        if (first) {
+                            net->cost += cost_value(grid_.cost(e));
+                            if (eco_) eco_edges.push_back(e);
+                        }
                     }
+                });
+                if (twopin->overflow) {
+                    net->overflow_twopin++;
+                    oftp++;
                 }
             }
-            if (twopin->overflow) {
-                net->overflow_twopin++;
-                oftp++;
-            }
+            for (auto& ne : net->edges) grid_.used(ne.e) = 0;
         }
         wl += net->wlen;
         if (net->overflow)
             ofnet++;
-        for (auto twopin : net->twopins)
-            for (auto rp : twopin->path)
-                getEdge(rp).used--;
+    }
+
+    if (eco_) {
+        std::sort(eco_edges.begin(), eco_edges.end());
+        eco_edges.erase(std::unique(eco_edges.begin(), eco_edges.end()), eco_edges.end());
+        for (auto i : eco_edges) {
+            auto of = grid_.demand(i) - grid_.cap(i);
+            totof += of;
+            if (of > mxof) mxof = of;
+        }
     }
     
     if (print_)
@@ -234,41 +359,31 @@ int RoutingCore::check_overflow() {
 
 // Lshape
 void RoutingCore::Lshape(TwoPinPtr twopin) {
-    patterns::Lshape(*twopin, [&](int x, int y, bool hori) -> double {
-        return cost(x, y, hori);
-    });
+    patterns::Lshape(*twopin, grid_);
 }
 
 // Zshape
 void RoutingCore::Zshape(TwoPinPtr twopin) {
-    patterns::Zshape(*twopin, [&](int x, int y, bool hori) -> double {
-        return cost(x, y, hori);
-    });
+    patterns::Zshape(*twopin, prefix_);
 }
 
 // monotonic
 void RoutingCore::monotonic(TwoPinPtr twopin) {
-    patterns::Monotonic(*twopin, [&](int x, int y, bool hori) -> double {
-        return cost(x, y, hori);
-    });
+    patterns::MonotonicWavefront(*twopin, grid_);
 }
 
 // HUM
 void RoutingCore::HUM(TwoPinPtr twopin) {
-    hum::HUM(*twopin, grid_, cost_model_, width_, height_);
+    hum::HUM(*twopin, boxes_[twopin->id], grid_, cost_model_, width_, height_);
 }
 
 // ripup_place
-void RoutingCore::ripup_place(FP fp) {
-    sort_twopins();
+template<typename Model>
+void RoutingCore::ripup_place(FP fp, const Model& cm) {
+    sort_twopins<typename Model::policy>();
     for (auto net : nets_) {
         for (auto twopin : net->twopins) {
-            twopin->overflow = false;
-            for (auto rp : twopin->path)
-                if (getEdge(rp).overflow()) {
-                    twopin->overflow = true;
-                    break;
-                }
+            twopin->overflow = any_edge(*twopin, [&](std::size_t e) { return grid_.overflow(e); });
         }
         
         del_cost(net);
@@ -276,7 +391,7 @@ void RoutingCore::ripup_place(FP fp) {
         for (auto twopin : net->twopins) {
             if (twopin->overflow) {
                 ripup(twopin);
-                add_cost(twopin);
+                add_cost(twopin, cm);
             }
         }
         
@@ -288,14 +403,15 @@ void RoutingCore::ripup_place(FP fp) {
             }
         }
         
-        add_cost(net);
+        add_cost(net, cm);
     }
     if (stop_) throw false;
 }
 
 // ripup_place_wl
-void RoutingCore::ripup_place_wl(FP fp) {
-    sort_twopins();
+template<typename Model>
+void RoutingCore::ripup_place_wl(FP fp, const Model& cm) {
+    sort_twopins<typename Model::policy>();
     for (auto net : nets_) {
         del_cost(net);
         
@@ -305,38 +421,32 @@ void RoutingCore::ripup_place_wl(FP fp) {
                 std::abs(twopin->from.x - twopin->to.x) + std::abs(twopin->from.y - twopin->to.y) <= 2)
                 continue;
             
-            auto old_path = twopin->path;
+            // Keep the old path in the scratch and route the candidate into
+            // the two-pin's own storage; swapping the two never allocates.
+            path_scratch_ = twopin->path;
             (this->*fp)(twopin);
-            auto candidate = twopin->path;
-            twopin->path = old_path;
-            
-            if (candidate.size() >= old_path.size()) continue;
-            
-            auto in_old = [&](const RPoint& rp) {
-                for (const auto& p : old_path)
-                    if (p.x == rp.x && p.y == rp.y && p.z == rp.z && p.hori == rp.hori)
-                        return true;
-                return false;
-            };
             
-            bool safe = true;
-            for (const auto& rp : candidate) if (!in_old(rp)) {
-                const auto& e = getEdge(rp);
-                if (e.demand >= e.cap) {
-                    safe = false;
-                    break;
+            bool safe = twopin->path.size() < path_scratch_.size();
+            if (safe) {
+                for (const auto& rp : twopin->path) if (!path_scratch_.contains(rp)) {
+                    auto e = edge(rp);
+                    if (grid_.demand(e) >= grid_.cap(e)) {
+                        safe = false;
+                        break;
+                    }
                 }
             }
+            twopin->path.swap(path_scratch_);  // back to the old path
             if (!safe) continue;
             
             ripup(twopin);
-            add_cost(twopin);
-            twopin->path = candidate;
+            add_cost(twopin, cm);
+            twopin->path.swap(path_scratch_);
             place(twopin);
             del_cost(twopin);
         }
         
-        add_cost(net);
+        add_cost(net, cm);
     }
     if (stop_) throw false;
 }
@@ -347,12 +457,22 @@ void RoutingCore::routing(const char* name, FP fp, int iteration, int sel_cost)
     cost_model_.set_selcost(sel_cost);
     if (print_) std::cerr << "[*] " << name << " routing" << std::endl;
     auto start = std::chrono::steady_clock::now();
-    build_cost();
     
+    int first = 1;
     int prev_of = std::numeric_limits<int>::max();
     int stall = 0;
-    for (int i = 1; i <= iteration; i++) {
-        ripup_place(fp);
+    if (resuming_ && resume_.phase == phase_) {
+        // Edge costs come from the checkpoint; a rebuild would differ mid-phase.
+        resuming_ = false;
+        first = resume_.iteration;
+        prev_of = resume_.prev_of;
+        stall = resume_.stall;
+    } else {
+        build_cost();
+    }
+    for (int i = first; i <= iteration; i++) {
+        sync_prefix(fp);
+        cost_model_.visit([&](const auto& cm) { ripup_place(fp, cm); });
         if (print_) std::cerr << " " << i << " time " << sec_since(start) << "s";
         int of = check_overflow();
         if (of == 0) throw true;
@@ -366,6 +486,7 @@ void RoutingCore::routing(const char* name, FP fp, int iteration, int sel_cost)
         if (stall >= 100) break;
         
         if (stop_) throw false;
+        if (i < iteration) maybe_checkpoint({phase_, i + 1, prev_of, stall});
     }
     if (print_) std::cerr << name << " routing costs " << sec_since(start) << "s" << std::endl;
 }
@@ -376,10 +497,17 @@ void RoutingCore::refine_wirelength(const char* name, FP fp, int iteration, int
     cost_model_.set_selcost(sel_cost);
     if (print_) std::cerr << "[*] " << name << " refine WL" << std::endl;
     auto start = std::chrono::steady_clock::now();
-    build_cost();
     
-    for (int i = 1; i <= iteration; i++) {
-        ripup_place_wl(fp);
+    int first = 1;
+    if (resuming_ && resume_.phase == phase_) {
+        resuming_ = false;
+        first = resume_.iteration;
+    } else {
+        build_cost();
+    }
+    for (int i = first; i <= iteration; i++) {
+        sync_prefix(fp);
+        cost_model_.visit([&](const auto& cm) { ripup_place_wl(fp, cm); });
         if (print_) std::cerr << " " << i << " time " << sec_since(start) << "s";
         int of = check_overflow();
         if (of > 0) {
@@ -387,6 +515,7 @@ void RoutingCore::refine_wirelength(const char* name, FP fp, int iteration, int
             break;
         }
         if (stop_) throw false;
+        if (i < iteration) maybe_checkpoint({phase_, i + 1, 0, 0});
     }
     if (print_) std::cerr << name << " refine WL costs " << sec_since(start) << "s" << std::endl;
 }
@@ -404,19 +533,20 @@ void RoutingCore::preroute(IspdData& /* data */) {
         }
     }
     
-    sort_twopins();
     build_cost();
-    
-    for (auto net : nets_) {
-        net->wlen = 0;
-        for (auto twopin : net->twopins) {
-            twopin->ripup = true;
-            Lshape(twopin);
-            place(twopin);
-            del_cost(twopin);
+    cost_model_.visit([&](const auto& cm) {
+        sort_twopins<typename std::decay_t<decltype(cm)>::policy>();
+        for (auto net : nets_) {
+            net->wlen = 0;
+            for (auto twopin : net->twopins) {
+                twopin->ripup = true;
+                Lshape(twopin);
+                place(twopin);
+                del_cost(twopin);
+            }
+            add_cost(net, cm);
         }
-        add_cost(net);
-    }
+    });
     
     if (print_) std::cerr << " time " << sec_since(start) << "s";
     check_overflow();
@@ -424,31 +554,6 @@ void RoutingCore::preroute(IspdData& /* data */) {
 
 // construct_2D_grid_graph
 void RoutingCore::construct_2D_grid_graph() {
-    // Filter nets: remove nets with >1000 pins or <=1 2D pins
-    ispdData_->nets.erase(
-        std::remove_if(ispdData_->nets.begin(), ispdData_->nets.end(), [&](auto& net) {
-            for (auto& _pin : net.pins) {
-                int x = (std::get<0>(_pin) - ispdData_->lowerLeftX) / ispdData_->tileWidth;
-                int y = (std::get<1>(_pin) - ispdData_->lowerLeftY) / ispdData_->tileHeight;
-                int z = std::get<2>(_pin) - 1;
-                
-                if (std::any_of(net.pin3D.begin(), net.pin3D.end(), [x, y, z](const auto& pin) {
-                    return pin.x == x && pin.y == y && pin.z == z;
-                })) continue;
-                net.pin3D.emplace_back(x, y, z);
-                
-                if (std::any_of(net.pin2D.begin(), net.pin2D.end(), [x, y](const auto& pin) {
-                    return pin.x == x && pin.y == y;
-                })) continue;
-                net.pin2D.emplace_back(x, y, 0);
-            }
-            
-            return net.pin3D.size() > 1000 || net.pin2D.size() <= 1;
-        }),
-        ispdData_->nets.end()
-    );
-    ispdData_->numNet = (int)ispdData_->nets.size();
-    
     auto verticalCapacity = std::accumulate(ispdData_->verticalCapacity.begin(),
                                             ispdData_->verticalCapacity.end(), 0);
     auto horizontalCapacity = std::accumulate(ispdData_->horizontalCapacity.begin(),
@@ -462,54 +567,88 @@ void RoutingCore::construct_2D_grid_graph() {
     for (auto& capacityAdj : ispdData_->capacityAdjs) {
         auto [x1, y1, z1] = capacityAdj.grid1;
         auto [x2, y2, z2] = capacityAdj.grid2;
-        if (z1 != z2) continue;
+        if (z1 != z2 || z1 < 1 || z1 > ispdData_->numLayer) continue;
         auto z = (std::size_t)z1 - 1;
         auto lx = std::min(x1, x2), rx = std::max(x1, x2);
         auto ly = std::min(y1, y2), ry = std::max(y1, y2);
         auto dx = rx - lx, dy = ry - ly;
         if (dx + dy != 1) continue;
         auto hori = (dx != 0);
-        auto& edge = getEdge(lx, ly, hori);
+        if (!grid_.contains(lx, ly, hori)) continue;
+        auto e = grid_.index(lx, ly, hori);
         auto layerCap = hori ? ispdData_->horizontalCapacity[z] : ispdData_->verticalCapacity[z];
-        edge.cap -= (layerCap - capacityAdj.reducedCapacityLevel) / min_net_;
+        grid_.cap(e) -= (layerCap - capacityAdj.reducedCapacityLevel) / min_net_;
     }
 }
 
-// net_decomposition
-void RoutingCore::net_decomposition() {
+// wrap_nets: (re)build the net wrappers and per-two-pin state in data order.
+// A two-pin that already has an id (routed by this core before) keeps its HUM box.
+void RoutingCore::wrap_nets() {
+    nets_.clear();
+    wrappers_.clear();
+    net_pool_.clear();
+    free_nets_.clear();
+    free_boxes_.clear();
+    net_names_.clear();
+    eco_users_.clear();
+    eco_sorted_ = 0;
+    eco_indexed_ = false;
+    wrappers_.reserve(ispdData_->nets.size());
+    auto twopin_count = std::accumulate(ispdData_->nets.begin(), ispdData_->nets.end(), 0u,
+                                        [&](auto s, auto& net) {
+                                            return s + net.twopin.size();
+                                        });
+    std::vector<hum::SearchBox> boxes;
+    boxes.reserve(twopin_count);
+    
     for (auto& net : ispdData_->nets) {
-        auto sz = net.pin2D.size();
-        net.twopin.clear();
-        net.twopin.reserve(sz - 1);
-        std::vector<bool> vis(sz, false);
-        std::priority_queue<std::tuple<int, std::size_t, std::size_t>> pq{};
-        
-        auto add = [&](std::size_t i) {
-            vis[i] = true;
-            auto [xi, yi, zi] = net.pin2D[i];
-            for (std::size_t j = 0; j < sz; j++) if (!vis[j]) {
-                auto [xj, yj, zj] = net.pin2D[j];
-                auto d = std::abs(xi - xj) + std::abs(yi - yj);
-                pq.emplace(-d, i, j);
+        auto mynet = &net_pool_.emplace_back(&net);
+        mynet->twopins.reserve(net.twopin.size());
+        wrappers_.push_back(mynet);
+        for (auto& twopin : net.twopin) {
+            bool kept = twopin.id >= 0 && static_cast<std::size_t>(twopin.id) < boxes_.size();
+            boxes.push_back(kept ? boxes_[twopin.id] : hum::SearchBox::around(twopin));
+            twopin.id = static_cast<int>(boxes.size()) - 1;
+            mynet->twopins.emplace_back(&twopin);
+        }
+        collect_net_edges(mynet);
+    }
+    boxes_ = std::move(boxes);
+    nets_ = wrappers_;
+}
+
+// new_wrapper: a wrapper for net, reusing a dropped net's
+RoutingCore::NetWrapper* RoutingCore::new_wrapper(Net* net) {
+    if (free_nets_.empty()) return &net_pool_.emplace_back(net);
+    auto w = free_nets_.back();
+    free_nets_.pop_back();
+    w->net = net;
+    return w;
+}
+
+// rewrap: reset a wrapper to what wrap_nets gives (two-pins in design order,
+// no stats), keeping its edges; new two-pins get an id and a fresh HUM box
+void RoutingCore::rewrap(NetWrapper* net) {
+    net->overflow = net->overflow_twopin = net->wlen = net->reroute = 0;
+    net->score = net->cost = 0;
+    net->twopins.clear();
+    for (auto& twopin : net->net->twopin) {
+        if (twopin.id < 0) {
+            if (free_boxes_.empty()) {
+                twopin.id = static_cast<int>(boxes_.size());
+                boxes_.emplace_back();
+            } else {
+                twopin.id = free_boxes_.back();
+                free_boxes_.pop_back();
             }
-        };
-        
-        add(0);
-        while (!pq.empty()) {
-            auto [d, i, j] = pq.top();
-            pq.pop();
-            if (vis[j]) continue;
-            TwoPin tp;
-            tp.from = net.pin2D[i];
-            tp.to = net.pin2D[j];
-            net.twopin.emplace_back(tp);
-            add(j);
+            boxes_[twopin.id] = hum::SearchBox::around(twopin);
         }
+        net->twopins.push_back(&twopin);
     }
 }
 
-// route
-void RoutingCore::route(IspdData& data, bool leave) {
+// setup: prepare nets, build the grid and the net wrappers
+void RoutingCore::setup(IspdData& data) {
     ispdData_ = &data;
     width_ = (std::size_t)ispdData_->numXGrid;
     height_ = (std::size_t)ispdData_->numYGrid;
@@ -517,72 +656,349 @@ void RoutingCore::route(IspdData& data, bool leave) {
     min_spacing_ = average(ispdData_->minimumSpacing);
     min_net_ = min_width_ + min_spacing_;
     
+    // Pin projection + MST decomposition; skipped for designs loaded from a snapshot.
+    if (ispdData_->decomposed)
+        reset_routing_state(*ispdData_);
+    else
+        prepare_nets(*ispdData_);
     construct_2D_grid_graph();
-    net_decomposition();
-    
-    // Build Net wrappers
-    for (auto net : nets_) delete net;
-    nets_.clear();
-    nets_.reserve(ispdData_->nets.size());
-    auto twopin_count = std::accumulate(ispdData_->nets.begin(), ispdData_->nets.end(), 0u,
-                                        [&](auto s, auto& net) {
-                                            return s + net.twopin.size();
-                                        });
-    twopins_.reserve(twopin_count);
-    
-    for (auto& net : ispdData_->nets) {
-        auto mynet = new NetWrapper(&net);
-        mynet->twopins.reserve(net.twopin.size());
-        nets_.emplace_back(mynet);
-        for (auto& twopin : net.twopin) {
-            twopins_.emplace_back(&twopin);
-            mynet->twopins.emplace_back(&twopin);
-        }
+    reset_edge_tracking();
+    wrap_nets();
+    last_ckpt_ = std::chrono::steady_clock::now();
+}
+
+// run_phases: the routing and refine phases after preroute (resumed ones pick up mid-phase)
+void RoutingCore::run_phases() {
+    struct Step {
+        Phase phase;
+        bool enabled, refine;
+        const char* name;
+        FP fp;
+        int iteration, sel;
+    };
+    const Step steps[] = {
+        {Phase::Lshape, cfg_.iter_lshape > 0, false, "Lshape", &RoutingCore::Lshape,
+         cfg_.iter_lshape, cfg_.selcost_pattern},
+        {Phase::Zshape, cfg_.iter_zshape > 0, false, "Zshape", &RoutingCore::Zshape,
+         cfg_.iter_zshape, cfg_.selcost_pattern},
+        {Phase::Monotonic, cfg_.iter_monotonic > 0, false, "monotonic", &RoutingCore::monotonic,
+         cfg_.iter_monotonic, cfg_.selcost_monotonic},
+        {Phase::HUM, cfg_.enable_hum && cfg_.iter_hum > 0, false, "HUM", &RoutingCore::HUM,
+         cfg_.iter_hum, cfg_.selcost_hum},
+        {Phase::RefineMonotonic, cfg_.enable_refine, true, "refine WL monotonic", &RoutingCore::monotonic,
+         cfg_.refine_iters, cfg_.selcost_refine},
+        {Phase::RefineZshape, cfg_.enable_refine, true, "refine WL Zshape", &RoutingCore::Zshape,
+         cfg_.refine_iters, cfg_.selcost_refine},
+        {Phase::RefineLshape, cfg_.enable_refine, true, "refine WL Lshape", &RoutingCore::Lshape,
+         cfg_.refine_iters, cfg_.selcost_refine},
+    };
+    for (auto& step : steps) {
+        if (!step.enabled) continue;
+        if (resuming_ && step.phase < resume_.phase) continue;  // finished before the checkpoint
+        phase_ = step.phase;
+        try {
+            if (step.refine)
+                refine_wirelength(step.name, step.fp, step.iteration, phase_selcost(step.sel));
+            else
+                routing(step.name, step.fp, step.iteration, phase_selcost(step.sel));
+        } catch (bool done) { if (!done) throw; }
+    }
+    resuming_ = false;
+}
+
+// maybe_checkpoint: write a checkpoint if one is due
+void RoutingCore::maybe_checkpoint(const Progress& at) {
+    if (ckpt_.path.empty() || eco_ || sec_since(last_ckpt_) < ckpt_.interval_sec) return;
+    // Write aside and rename, so an interruption never leaves a torn checkpoint.
+    auto tmp = ckpt_.path + ".tmp";
+    try {
+        write_checkpoint(tmp, at);
+        if (std::rename(tmp.c_str(), ckpt_.path.c_str()) != 0)
+            throw std::runtime_error("failed to rename " + tmp + " to " + ckpt_.path);
+    } catch (const std::runtime_error& e) {
+        // Losing a checkpoint must not kill the run.
+        std::cerr << "[WARNING] checkpoint failed: " << e.what() << std::endl;
+        return;
     }
+    last_ckpt_ = std::chrono::steady_clock::now();
+    if (ckpt_.on_write) ckpt_.on_write(ckpt_.path);
+}
+
+// route
+void RoutingCore::route(IspdData& data, bool leave) {
+    setup(data);
     
     // Select initial selcost
-    if (cfg_.adaptive_scoring) {
-        selcost_ = cfg_.selcost_pattern;
-    } else {
-        selcost_ = cfg_.selcost_fixed;
-    }
+    selcost_ = phase_selcost(cfg_.selcost_pattern);
     cost_model_.set_selcost(selcost_);
     preroute(data);
     if (leave) return;
-    
-    auto sel_for = [&](int phase_selcost) -> int {
-        return cfg_.adaptive_scoring ? phase_selcost : cfg_.selcost_fixed;
-    };
+    run_phases();
+}
 
-    try {
-        if (cfg_.iter_lshape > 0)
-            routing("Lshape", &RoutingCore::Lshape, cfg_.iter_lshape, sel_for(cfg_.selcost_pattern));
-    } catch (bool done) { if (!done) throw; }
+// resume
+void RoutingCore::resume(IspdData& data, const std::string& checkpoint_path) {
+    setup(data);
+    read_checkpoint(checkpoint_path);
+    run_phases();
+}
 
-    try {
-        if (cfg_.iter_zshape > 0)
-            routing("Zshape", &RoutingCore::Zshape, cfg_.iter_zshape, sel_for(cfg_.selcost_pattern));
-    } catch (bool done) { if (!done) throw; }
+// release: take a placed net off the grid (demand, cost), drop its paths and
+// free its two-pins' boxes; the wrapper is left with no two-pins or edges
+void RoutingCore::release(NetWrapper* net) {
+    auto& twopins = net->net->twopin;
+    for (auto& twopin : twopins)
+        for_each_edge(twopin, [&](std::size_t e) { grid_.used(e)++; });
+    for (auto& twopin : twopins)
+        ripup(&twopin);
+    cost_model_.visit([&](const auto& cm) {
+        for (auto& twopin : twopins) {
+            add_cost(&twopin, cm);
+            twopin.path.clear();
+        }
+    });
+    for (auto& twopin : twopins) {
+        if (twopin.id >= 0) free_boxes_.push_back(twopin.id);
+        twopin.id = -1;
+    }
+    net->twopins.clear();
+    net->edges.clear();
+    net->gen++;
+}
 
-    try {
-        if (cfg_.iter_monotonic > 0)
-            routing("monotonic", &RoutingCore::monotonic, cfg_.iter_monotonic, sel_for(cfg_.selcost_monotonic));
-    } catch (bool done) { if (!done) throw; }
+// index_eco_users: (edge, net) for the edges of every net outside the working
+// set. Built once per route; eco() keeps it current afterwards.
+void RoutingCore::index_eco_users() {
+    eco_users_.clear();
+    for (auto net : wrappers_)
+        if (!net->eco_work)
+            for (auto& ne : net->edges) eco_users_.push_back({ne.e, net->gen, net});
+    std::sort(eco_users_.begin(), eco_users_.end());
+    eco_sorted_ = eco_users_.size();
+    eco_indexed_ = true;
+}
+
+// reindex_eco_users: after an eco, index the working set's new edges in the
+// sorted tail; their old entries went stale with the gen bump. The tail is
+// folded in, and stale entries dropped, once it outgrows a quarter of the rest.
+void RoutingCore::reindex_eco_users() {
+    for (auto net : nets_) net->gen++;
+    if (!eco_indexed_) return;
+    auto tail = eco_users_.size();
+    for (auto net : nets_)
+        for (auto& ne : net->edges) eco_users_.push_back({ne.e, net->gen, net});
+    auto sorted = eco_users_.begin() + static_cast<std::ptrdiff_t>(eco_sorted_);
+    std::sort(eco_users_.begin() + static_cast<std::ptrdiff_t>(tail), eco_users_.end());
+    std::inplace_merge(sorted, eco_users_.begin() + static_cast<std::ptrdiff_t>(tail), eco_users_.end());
+    if (eco_users_.size() - eco_sorted_ <= eco_sorted_ / 4) return;
+    std::inplace_merge(eco_users_.begin(), sorted, eco_users_.end());
+    eco_users_.erase(std::remove_if(eco_users_.begin(), eco_users_.end(),
+                                    [](const EcoUser& u) { return u.gen != u.net->gen; }),
+                     eco_users_.end());
+    eco_sorted_ = eco_users_.size();
+}
+
+// expand_eco: add every net outside the working set that uses an edge the set overflows
+bool RoutingCore::expand_eco() {
+    eco_hot_.clear();
+    for (auto net : nets_)
+        for (auto twopin : net->twopins)
+            for_each_edge(*twopin, [&](std::size_t e) {
+                if (grid_.overflow(e)) eco_hot_.insert(e);
+            });
+    if (eco_hot_.empty()) return false;
+
+    if (!eco_indexed_) index_eco_users();
+    std::vector<NetWrapper*> found;
+    auto take = [&](auto first, auto last, std::uint32_t e) {
+        for (auto it = std::lower_bound(first, last, EcoUser{e, 0, nullptr}); it != last && it->e == e; ++it) {
+            auto net = it->net;
+            if (it->gen != net->gen || net->eco_work) continue;
+            net->eco_work = true;
+            found.push_back(net);
+        }
+    };
+    auto sorted = eco_users_.begin() + static_cast<std::ptrdiff_t>(eco_sorted_);
+    for (auto e : eco_hot_) {
+        take(eco_users_.begin(), sorted, static_cast<std::uint32_t>(e));
+        take(sorted, eco_users_.end(), static_cast<std::uint32_t>(e));
+    }
+    // Design order, as a scan over all nets would add them.
+    std::sort(found.begin(), found.end(), [](auto a, auto b) { return a->net < b->net; });
+    for (auto net : found) {
+        rewrap(net);
+        nets_.push_back(net);
+    }
+    return !found.empty();
+}
 
-    if (cfg_.enable_hum) {
+// eco_route: route the working set (nets_), whose two-pins have no path yet
+int RoutingCore::eco_route() {
+    selcost_ = phase_selcost(cfg_.selcost_pattern);
+    cost_model_.set_selcost(selcost_);
+    build_cost();
+    cost_model_.visit([&](const auto& cm) {
+        for (auto net : nets_) {
+            for (auto twopin : net->twopins) {
+                twopin->ripup = true;
+                Lshape(twopin);
+                place(twopin);
+                del_cost(twopin);
+            }
+            add_cost(net, cm);
+        }
+    });
+    if (print_) std::cerr << "[*] ECO pattern routing";
+    int of = check_overflow();
+
+    // Escalate like route(); when that is not enough, reroute the nets the
+    // working set pushed into overflow as well.
+    for (int round = 0; of > 0; round++) {
         try {
-            if (cfg_.iter_hum > 0)
-                routing("HUM", &RoutingCore::HUM, cfg_.iter_hum, sel_for(cfg_.selcost_hum));
-        } catch (bool done) { if (!done) throw; }
+            if (cfg_.iter_zshape > 0)
+                routing("ECO Zshape", &RoutingCore::Zshape, cfg_.iter_zshape, phase_selcost(cfg_.selcost_pattern));
+            if (cfg_.iter_monotonic > 0)
+                routing("ECO monotonic", &RoutingCore::monotonic, cfg_.iter_monotonic,
+                        phase_selcost(cfg_.selcost_monotonic));
+            if (cfg_.enable_hum && cfg_.eco_iter_hum > 0)
+                routing("ECO HUM", &RoutingCore::HUM, cfg_.eco_iter_hum, phase_selcost(cfg_.selcost_hum));
+        } catch (bool done) {
+            if (!done) throw;
+            of = 0;
+            break;
+        }
+        if (round >= cfg_.eco_expand_rounds || !expand_eco()) break;
+        if (print_) std::cerr << "[*] ECO working set grew to " << nets_.size() << " nets";
+        of = check_overflow();
     }
 
     if (cfg_.enable_refine) {
         const int it = cfg_.refine_iters;
-        const int sel = sel_for(cfg_.selcost_refine);
-        refine_wirelength("refine WL monotonic", &RoutingCore::monotonic, it, sel);
-        refine_wirelength("refine WL Zshape", &RoutingCore::Zshape, it, sel);
-        refine_wirelength("refine WL Lshape", &RoutingCore::Lshape, it, sel);
+        const int sel = phase_selcost(cfg_.selcost_refine);
+        refine_wirelength("ECO refine WL monotonic", &RoutingCore::monotonic, it, sel);
+        refine_wirelength("ECO refine WL Zshape", &RoutingCore::Zshape, it, sel);
+        refine_wirelength("ECO refine WL Lshape", &RoutingCore::Lshape, it, sel);
     }
+    if (print_) std::cerr << "[*] ECO result";
+    return check_overflow();
+}
+
+// eco: apply delta and reroute only what it touches. The wrappers, their edge
+// lists, the name index and eco_users_ persist across ecos, so the work here
+// scales with the delta and the nets it disturbs rather than with the design.
+EcoStats RoutingCore::eco(IspdData& data, const NetlistDelta& delta) {
+    if (ispdData_ != &data || grid_.size() == 0)
+        throw std::runtime_error("RoutingCore::eco: design was not routed by this core");
+    auto start = std::chrono::steady_clock::now();
+    if (net_names_.empty()) {
+        net_names_.reserve(wrappers_.size());
+        for (auto net : wrappers_) net_names_.emplace(net->net->name, net);
+    }
+    check_delta(data, [&](const std::string& name) { return net_names_.count(name) != 0; }, delta);
+
+    EcoStats st;
+    std::vector<NetWrapper*> dropped, work;
+    for (auto& name : delta.removed) {
+        auto it = net_names_.find(name);
+        release(it->second);
+        dropped.push_back(it->second);
+        net_names_.erase(it);
+        st.removed++;
+    }
+    for (auto& src : delta.updated) {
+        auto net = net_names_.at(src.name);
+        release(net);
+        assign_net(data, *net->net, src);
+        work.push_back(net);
+        st.updated++;
+    }
+    if (data.nets.size() + delta.added.size() > data.nets.capacity()) {
+        // Grow geometrically: each move of the nets re-points every wrapper.
+        // Moving a Net keeps its two-pins in place, so wrapper twopins stay valid.
+        static_assert(std::is_nothrow_move_constructible_v<Net>, "data.nets must move, not copy");
+        data.nets.reserve(std::max(2 * data.nets.size(), data.nets.size() + delta.added.size()));
+        for (std::size_t i = 0; i < data.nets.size(); i++) wrappers_[i]->net = &data.nets[i];
+    }
+    for (auto& src : delta.added) {
+        auto& net = data.nets.emplace_back();
+        assign_net(data, net, src);
+        auto w = new_wrapper(&net);
+        wrappers_.push_back(w);
+        net_names_.emplace(src.name, w);
+        work.push_back(w);
+        st.added++;
+    }
+    auto design_order = [](NetWrapper* a, NetWrapper* b) { return a->net < b->net; };
+    std::sort(work.begin(), work.end(), design_order);
+    std::size_t routable = 0;
+    for (auto net : work) {
+        project_net_pins(data, *net->net);
+        if (routable_net(*net->net)) {
+            decompose_net(data, *net->net);
+            work[routable++] = net;
+        } else {  // filtered, as prepare_nets does
+            net_names_.erase(net->net->name);
+            dropped.push_back(net);
+        }
+    }
+    work.resize(routable);
+
+    // Close the gaps from the first dropped net on, keeping wrappers_ parallel to data.nets.
+    if (!dropped.empty()) {
+        std::sort(dropped.begin(), dropped.end(), design_order);
+        std::size_t kept = static_cast<std::size_t>(dropped.front()->net - data.nets.data());
+        std::size_t d = 0;
+        for (std::size_t i = kept; i < data.nets.size(); i++) {
+            if (d < dropped.size() && wrappers_[i] == dropped[d]) {
+                d++;
+                continue;
+            }
+            if (kept != i) {
+                data.nets[kept] = std::move(data.nets[i]);
+                wrappers_[kept] = wrappers_[i];
+                wrappers_[kept]->net = &data.nets[kept];
+            }
+            kept++;
+        }
+        data.nets.erase(data.nets.begin() + static_cast<std::ptrdiff_t>(kept), data.nets.end());
+        wrappers_.resize(kept);
+        for (auto net : dropped) {
+            net->net = nullptr;
+            free_nets_.push_back(net);
+        }
+    }
+    data.numNet = static_cast<int>(data.nets.size());
+
+    // Route only the working set: it stands in as nets_ for the routing phases.
+    for (auto net : work) {
+        rewrap(net);
+        net->eco_work = true;
+    }
+    nets_ = std::move(work);
+    auto done = [&] {
+        eco_ = false;
+        for (auto net : nets_) net->eco_work = false;
+        reindex_eco_users();
+    };
+    eco_ = true;
+    try {
+        st.overflow = eco_route();
+    } catch (...) {
+        done();
+        nets_ = wrappers_;
+        throw;
+    }
+    done();
+    st.rerouted_nets = static_cast<int>(nets_.size());
+    for (auto net : nets_) st.rerouted_twopins += static_cast<int>(net->twopins.size());
+    nets_ = wrappers_;
+    st.runtime_sec = sec_since(start);
+
+    if (print_)
+        std::cerr << "[*] ECO removed " << st.removed << " updated " << st.updated << " added " << st.added
+                  << " nets, rerouted " << st.rerouted_nets << " nets (" << st.rerouted_twopins
+                  << " twopins) in " << st.runtime_sec << "s, overflow " << st.overflow << std::endl;
+    return st;
 }
 
 // Legacy interface for backward compatibility
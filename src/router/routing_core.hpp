@@ -1,11 +1,20 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "router/ispd_data.hpp"
-#include "router/grid_graph.hpp"
 #include "router/cost_model.hpp"
+#include "router/cost_prefix.hpp"
+#include "router/edge_set.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/eco.hpp"
+#include "router/hum.hpp"
 
 namespace vlsigr {
 
@@ -33,6 +42,16 @@ public:
         int iter_monotonic = 5;
         int iter_hum = 10000;
         int refine_iters = 4;
+
+        // ECO: HUM iteration cap, and how many times the rerouted set may grow
+        // by the nets it pushes into overflow.
+        int eco_iter_hum = 50;
+        int eco_expand_rounds = 2;
+    };
+
+    // A grid edge of a net's route and how many of its two-pins use it.
+    struct NetEdge {
+        std::uint32_t e, uses;
     };
 
     struct NetWrapper {
@@ -40,9 +59,20 @@ public:
         double score, cost;
         Net* net;  // pointer to original net in IspdData
         std::vector<TwoPinPtr> twopins;
+        std::vector<NetEdge> edges;  // distinct edges of the paths, by index; kept by add_cost(net)
+        std::uint32_t gen = 0;       // bumped when edges change outside eco_users_
+        bool eco_work = false;       // in the ECO working set
         explicit NetWrapper(Net* n);
     };
 
+    // Periodic checkpoints of the full routing state (see checkpoint.hpp),
+    // written between iterations of the routing and refine phases.
+    struct CheckpointOptions {
+        std::string path;             // empty: no checkpoints
+        double interval_sec = 600.0;  // minimum time between writes; 0 writes after every iteration
+        std::function<void(const std::string& path)> on_write;  // after each successful write
+    };
+
     struct OverflowStats {
         int tot = 0;
         int mx = 0;
@@ -50,52 +80,159 @@ public:
     };
 
     RoutingCore();
-    ~RoutingCore();
+    RoutingCore(const RoutingCore&) = delete;
+    RoutingCore& operator=(const RoutingCore&) = delete;
 
     void set_config(const Config& cfg) { cfg_ = cfg; }
+    void set_checkpoint(CheckpointOptions opt) { ckpt_ = std::move(opt); }
 
     // Main routing entry
     void route(IspdData& data, bool leave = false);
+
+    // Continue an interrupted route() from a checkpoint written for the same
+    // design (parsed or snapshot-loaded again). The checkpoint's Config and RNG
+    // state are restored, so the result is identical to an uninterrupted run.
+    // Throws std::runtime_error if the checkpoint is unreadable or belongs to
+    // another design.
+    void resume(IspdData& data, const std::string& checkpoint_path);
     
     // Core routing functions
     void preroute(IspdData& data);
     void route_pipeline(IspdData& data);
+
+    // Incremental reroute after a netlist change. `data` must be the design this
+    // core last routed; its grid demand and history (Edge::he) are kept. Only the
+    // changed nets are ripped up and rerouted, plus nets sharing an edge they
+    // overflow. Throws std::runtime_error (before changing anything) if the
+    // delta does not apply.
+    EcoStats eco(IspdData& data, const NetlistDelta& delta);
     
-    const GridGraph<Edge>& grid() const { return grid_; }
+    const SoAGridGraph& grid() const { return grid_; }
     
 private:
     std::size_t width_, height_;
     int min_width_, min_spacing_, min_net_, mx_cap_;
-    GridGraph<Edge> grid_;
+    SoAGridGraph grid_;
+    // Per-net and per-two-pin state, rebuilt by wrap_nets and patched by
+    // eco. net_pool_ never moves a wrapper; wrappers_[i] wraps data.nets[i];
+    // nets_ is the visiting order. boxes_ is by TwoPin::id, with the ids of
+    // dropped two-pins in free_boxes_.
+    std::deque<NetWrapper> net_pool_;
+    std::vector<NetWrapper*> free_nets_;
+    std::vector<NetWrapper*> wrappers_;
+    std::vector<hum::SearchBox> boxes_;
+    std::vector<int> free_boxes_;
     std::vector<NetWrapper*> nets_;
-    std::vector<TwoPinPtr> twopins_;
+    SegmentPath path_scratch_;  // previous path in ripup_place_wl; storage swaps with the two-pins'
+    std::vector<std::uint32_t> placed_;     // edges new to the current net, recorded by place()
+    std::vector<NetEdge> edges_scratch_;    // swaps with NetWrapper::edges in update_net_edges
+
+    // Dirty-edge tracking: place/ripup record edges whose demand or pending
+    // history (Edge::of) changed; check_overflow folds them into the history,
+    // overflowed_ and stale_, and build_cost refreshes only stale_ while the
+    // cost model is unchanged. reset_edge_tracking rescans the grid.
+    EdgeSet changed_;                       // since the last check_overflow
+    EdgeSet stale_;                         // cost inputs changed since the last build_cost
+    std::vector<std::uint32_t> overflowed_; // over capacity at the last check_overflow
+    int built_selcost_ = -1;                // model of the last build_cost; -1 forces a full build
+    // Costs of the other models, parked by build_cost when it switches model,
+    // with the edges whose inputs changed since; switching back refreshes
+    // only those.
+    struct ParkedCosts {
+        std::vector<EdgeCost> cost;
+        EdgeSet dirty;
+        bool valid = false;
+    };
+    ParkedCosts parked_[AggressiveCost::selcost + 1];
+
+    // Running cost sums for Zshape; set_cost touches them only while
+    // prefix_live_, which sync_prefix turns on for the Z phases.
+    CostPrefix prefix_;
+    bool prefix_live_ = false;
     
     int selcost_;
     CostModel cost_model_;
     bool stop_, print_;
+    bool eco_ = false;  // nets_ holds only the ECO working set
+    // Net name -> wrapper, built by the first eco after wrap_nets.
+    std::unordered_map<std::string, NetWrapper*> net_names_;
+    // expand_eco state: edges the working set overflows, and which nets use
+    // each edge. eco_users_ is built by the first expansion after wrap_nets;
+    // each eco then appends its working set's edges (sorted after
+    // eco_sorted_) and an entry counts only while its gen is the net's.
+    struct EcoUser {
+        std::uint32_t e, gen;
+        NetWrapper* net;
+        bool operator<(const EcoUser& o) const { return e < o.e; }
+    };
+    EdgeSet eco_hot_;
+    std::vector<EcoUser> eco_users_;
+    std::size_t eco_sorted_ = 0;
+    bool eco_indexed_ = false;
+
+    // Phases of route() after preroute, in order.
+    enum class Phase : int {
+        Lshape, Zshape, Monotonic, HUM, RefineMonotonic, RefineZshape, RefineLshape
+    };
+    // Where a checkpoint was taken: the next iteration of `phase` and the
+    // stall-detection state of routing().
+    struct Progress {
+        Phase phase = Phase::Lshape;
+        int iteration = 1;
+        int prev_of = 0;
+        int stall = 0;
+    };
+    Phase phase_ = Phase::Lshape;
+    bool resuming_ = false;  // resume_ not yet consumed by its phase
+    Progress resume_{};
+    CheckpointOptions ckpt_{};
+    std::chrono::steady_clock::time_point last_ckpt_{};
+
+    void setup(IspdData& data);
+    void run_phases();
+    void maybe_checkpoint(const Progress& at);
+    void write_checkpoint(const std::string& path, const Progress& at) const;
+    void read_checkpoint(const std::string& path);
     IspdData* ispdData_;
     Config cfg_{};
 
+    void wrap_nets();
+    NetWrapper* new_wrapper(Net* net);
+    void rewrap(NetWrapper* net);
+    int phase_selcost(int sel) const { return cfg_.adaptive_scoring ? sel : cfg_.selcost_fixed; }
+
+    // ECO helpers (see eco()).
+    void release(NetWrapper* net);
+    int eco_route();
+    bool expand_eco();
+    void index_eco_users();
+    void reindex_eco_users();
+
     void ripup(TwoPinPtr twopin);
     void place(TwoPinPtr twopin);
     
+    // del_cost(net) masks the net's edges and loads their use counts into
+    // Edge::used; add_cost(net) undoes both and brings net->edges up to date.
+    // Cost loops take the BasicCostModel from cost_model_.visit, so selcost is
+    // dispatched once per pass rather than per edge.
     void del_cost(NetWrapper* net);
     void del_cost(TwoPinPtr twopin);
-    void add_cost(NetWrapper* net);
-    void add_cost(TwoPinPtr twopin);
+    template<typename Model> void add_cost(NetWrapper* net, const Model& cm);
+    template<typename Model> void add_cost(TwoPinPtr twopin, const Model& cm);
+    template<typename F> void update_net_edges(NetWrapper* net, F&& f);
+    void collect_net_edges(NetWrapper* net);
     
     int check_overflow();
-    void sort_twopins();
+    template<typename Policy> void sort_twopins();
     
-    inline double score(const TwoPinPtr twopin) const;
+    template<typename Policy> double score(const TwoPinPtr twopin) const;
     inline double score(const NetWrapper* net) const;
     inline int delta(const TwoPinPtr twopin) const;
     
     inline double cost(const TwoPinPtr twopin) const;
-    inline double cost(Point f, Point t) const;
-    inline double cost(RPoint rp) const;
-    inline double cost(int x, int y, bool hori) const;
-    inline double cost(const Edge& e) const;
+    inline EdgeCost cost(Point f, Point t) const;
+    inline EdgeCost cost(RPoint rp) const;
+    inline EdgeCost cost(int x, int y, bool hori) const;
     
     // Routing algorithms (function pointer type)
     using FP = void (RoutingCore::*)(TwoPinPtr);
@@ -106,21 +243,42 @@ private:
     
     // Routing phases
     void routing(const char* name, FP fp, int iteration, int sel_cost);
-    void ripup_place(FP fp);
+    template<typename Model> void ripup_place(FP fp, const Model& cm);
     void refine_wirelength(const char* name, FP fp, int iteration, int sel_cost);
-    void ripup_place_wl(FP fp);
+    template<typename Model> void ripup_place_wl(FP fp, const Model& cm);
     
-    // Grid construction
+    // Grid construction (capacities + adjustments); nets must already be prepared.
     void construct_2D_grid_graph();
-    void net_decomposition();
     
     // Helper for cost calculation
     void build_cost();
+    void reset_edge_tracking();
+    void sync_prefix(FP fp);
+
+    // Store edge e's cost; every cost write outside build_cost goes through here.
+    void set_cost(std::size_t e, EdgeCost c) {
+        grid_.cost(e) = c;
+        if (prefix_live_) prefix_.touch(e);
+    }
     
-    inline const Edge& getEdge(RPoint rp) const { return grid_.at(rp.x, rp.y, rp.hori); }
-    inline Edge& getEdge(RPoint rp) { return grid_.at(rp.x, rp.y, rp.hori); }
-    inline const Edge& getEdge(int x, int y, bool hori) const { return grid_.at(x, y, hori); }
-    inline Edge& getEdge(int x, int y, bool hori) { return grid_.at(x, y, hori); }
+    inline std::size_t edge(RPoint rp) const { return grid_.index(rp.x, rp.y, rp.hori); }
+
+    // Call f(edge index) for every unit edge of twopin's path, in path order,
+    // one straight run at a time; any_edge stops at the first f that holds.
+    template<typename F> void for_each_edge(const TwoPin& twopin, F&& f) const {
+        for (auto& s : twopin.path.segments()) {
+            auto line = grid_.run(s);
+            for (int k = 0, a = s.along(); k < static_cast<int>(s.len); k++, a += s.step()) f(line(a));
+        }
+    }
+    template<typename F> bool any_edge(const TwoPin& twopin, F&& f) const {
+        for (auto& s : twopin.path.segments()) {
+            auto line = grid_.run(s);
+            for (int k = 0, a = s.along(); k < static_cast<int>(s.len); k++, a += s.step())
+                if (f(line(a))) return true;
+        }
+        return false;
+    }
 };
 
 }  // namespace vlsigr
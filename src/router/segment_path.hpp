@@ -0,0 +1,161 @@
+#pragma once
+
+// Run-length encoded two-pin path: straight runs of unit edges instead of one
+// RPoint per edge, so a pattern route is two or three runs however long it
+// is. Iterating the path still yields unit edges, in the order they were
+// appended; code that updates the grid walks segments() one run at a time.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace vlsigr {
+
+struct RPoint {
+    int x = 0, y = 0, z = 0;
+    bool hori = false;
+    RPoint() = default;
+    RPoint(int x_, int y_, bool h): x(x_), y(y_), z(0), hori(h) {}
+    RPoint(int x_, int y_, int z_, bool h): x(x_), y(y_), z(z_), hori(h) {}
+};
+
+// len unit edges starting with edge (x, y, hori) and stepping along the
+// run's wire (x for horizontal runs, y for vertical ones), backwards if back.
+struct PathSegment {
+    int x, y;
+    std::uint32_t len : 30;
+    std::uint32_t hori : 1;
+    std::uint32_t back : 1;
+
+    PathSegment() = default;
+    PathSegment(int x_, int y_, bool h, unsigned n, bool b)
+        : x(x_), y(y_), len(n), hori(h), back(b) {}
+
+    int step() const { return back ? -1 : 1; }
+    int along() const { return hori ? x : y; }   // of the first edge
+    int across() const { return hori ? y : x; }
+    int last() const { return along() + step() * static_cast<int>(len - 1); }
+
+    RPoint operator[](unsigned k) const {
+        int d = step() * static_cast<int>(k);
+        return hori ? RPoint(x + d, y, true) : RPoint(x, y + d, false);
+    }
+};
+
+static_assert(sizeof(PathSegment) == 12, "PathSegment should pack into 12 bytes");
+
+class SegmentPath {
+    std::vector<PathSegment> segs_;
+    std::size_t size_ = 0;  // unit edges
+
+public:
+    // Input iterator over the unit edges; dereferences to an RPoint by value.
+    class const_iterator {
+        const PathSegment* seg_ = nullptr;
+        std::uint32_t k_ = 0;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = RPoint;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const RPoint*;
+        using reference = RPoint;
+
+        const_iterator() = default;
+        explicit const_iterator(const PathSegment* seg) : seg_(seg) {}
+
+        RPoint operator*() const { return (*seg_)[k_]; }
+        const_iterator& operator++() {
+            if (++k_ == seg_->len) {
+                ++seg_;
+                k_ = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const const_iterator& o) const { return seg_ == o.seg_ && k_ == o.k_; }
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+    };
+
+    SegmentPath() = default;
+    SegmentPath(std::initializer_list<RPoint> edges) {
+        for (auto& rp : edges) push_back(rp);
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear() {
+        segs_.clear();
+        size_ = 0;
+    }
+    void swap(SegmentPath& o) noexcept {
+        segs_.swap(o.segs_);
+        std::swap(size_, o.size_);
+    }
+    const std::vector<PathSegment>& segments() const { return segs_; }
+
+    // Whether the path uses edge (rp.x, rp.y, rp.hori).
+    bool contains(const RPoint& rp) const {
+        int along = rp.hori ? rp.x : rp.y, across = rp.hori ? rp.y : rp.x;
+        for (auto& s : segs_) {
+            if (s.hori != rp.hori || s.across() != across) continue;
+            int a = s.along(), b = s.last();
+            if (std::min(a, b) <= along && along <= std::max(a, b)) return true;
+        }
+        return false;
+    }
+
+    const_iterator begin() const { return const_iterator(segs_.data()); }
+    const_iterator end() const { return const_iterator(segs_.data() + segs_.size()); }
+
+    // Append one unit edge, extending the last run when the edge continues it.
+    void push_back(const RPoint& rp) {
+        int along = rp.hori ? rp.x : rp.y;
+        if (!segs_.empty()) {
+            auto& s = segs_.back();
+            if (s.hori == rp.hori && s.across() == (rp.hori ? rp.y : rp.x)) {
+                int last = s.last();
+                if (s.len == 1 && (along == last + 1 || along == last - 1)) s.back = along < last;
+                if (along == last + s.step()) {
+                    s.len++;
+                    size_++;
+                    return;
+                }
+            }
+        }
+        segs_.emplace_back(rp.x, rp.y, rp.hori, 1, false);
+        size_++;
+    }
+    void emplace_back(int x, int y, bool hori) { push_back(RPoint(x, y, hori)); }
+
+    // Append n unit edges from (x, y) along the wire, backwards if back; the
+    // same path as n push_back calls.
+    void append_run(int x, int y, bool hori, unsigned n, bool back = false) {
+        if (n == 0) return;
+        push_back(RPoint(x, y, hori));
+        auto& s = segs_.back();
+        if (n == 1) return;
+        if (s.len == 1) s.back = back;
+        if (s.back == back) {
+            s.len += n - 1;
+            size_ += n - 1;
+            return;
+        }
+        // Doubles back over the last run: no merge possible.
+        int d = back ? -1 : 1;
+        for (unsigned k = 1; k < n; k++)
+            push_back(hori ? RPoint(x + d * static_cast<int>(k), y, true)
+                           : RPoint(x, y + d * static_cast<int>(k), false));
+    }
+    void append_run(const PathSegment& s) { append_run(s.x, s.y, s.hori, s.len, s.back); }
+};
+
+}  // namespace vlsigr
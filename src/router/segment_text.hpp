@@ -0,0 +1,42 @@
+#pragma once
+
+// Text form of routed segments, shared by the ISPD text writers
+// (Graph::output3Dresult and ResultFile::write_text) so both print the same bytes.
+
+#include <charconv>
+#include <string>
+
+namespace vlsigr {
+
+// printf("%d") equivalent; returns the end of the written digits (at most 11).
+inline char* put_int(char* p, int v) { return std::to_chars(p, p + 11, v).ptr; }
+
+inline void append_int(std::string& out, int v) {
+    char buf[16];
+    out.append(buf, put_int(buf, v));
+}
+
+// "(x1,y1,z1)-(x2,y2,z2)\n", formatted in a stack buffer and appended once.
+inline void append_segment(std::string& out, int x1, int y1, int z1, int x2, int y2, int z2) {
+    char line[96];
+    char* p = line;
+    *p++ = '(';
+    p = put_int(p, x1);
+    *p++ = ',';
+    p = put_int(p, y1);
+    *p++ = ',';
+    p = put_int(p, z1);
+    *p++ = ')';
+    *p++ = '-';
+    *p++ = '(';
+    p = put_int(p, x2);
+    *p++ = ',';
+    p = put_int(p, y2);
+    *p++ = ',';
+    p = put_int(p, z2);
+    *p++ = ')';
+    *p++ = '\n';
+    out.append(line, p);
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,36 @@
+#pragma once
+
+// Shared pieces of the AVX2 kernels (cost_model.cpp, min_plus.cpp,
+// patterns.cpp). VLSIGR_AVX2 is defined where the compiler can target AVX2;
+// the kernels are built with target("avx2") and picked at run time by
+// have_avx2(), so the binary still runs on CPUs without it.
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define VLSIGR_AVX2 1
+#endif
+
+#include "router/edge_cost.hpp"
+
+namespace vlsigr {
+
+#ifdef VLSIGR_AVX2
+inline bool have_avx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+#ifdef VLSIGR_COST_FIXED
+__attribute__((target("avx2")))
+inline __m256i load8(const EdgeCost* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+// cost_add per lane: costs are non-negative int32, so the unsigned sum cannot
+// wrap, and min with kCostInf saturates.
+__attribute__((target("avx2")))
+inline __m256i sat_add(__m256i a, __m256i b) {
+    return _mm256_min_epu32(_mm256_add_epi32(a, b), _mm256_set1_epi32(kCostInf));
+}
+#endif
+#endif
+
+}  // namespace vlsigr
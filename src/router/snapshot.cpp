@@ -0,0 +1,191 @@
+#include "snapshot.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "router/binary_io.hpp"
+#include "router/mapped_file.hpp"
+
+namespace vlsigr {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'L', 'G', 'R', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kFlagDecomposed = 1u << 0;
+
+// Smallest encodings, for bounding counts read from the file.
+constexpr std::size_t kPointBytes = 3 * sizeof(std::int32_t);
+constexpr std::size_t kPinBytes = 3 * sizeof(std::int32_t);
+constexpr std::size_t kAdjBytes = 7 * sizeof(std::int32_t);
+// Name length, id, numPins, minimumWidth, then four empty lists.
+constexpr std::size_t kNetMinBytes = sizeof(std::uint32_t) + 3 * sizeof(std::int32_t) + 4 * sizeof(std::uint32_t);
+
+void put_point(BinaryWriter& w, const Point& p) {
+    w.put<std::int32_t>(p.x);
+    w.put<std::int32_t>(p.y);
+    w.put<std::int32_t>(p.z);
+}
+
+Point get_point(BinaryReader& r) {
+    Point p;
+    p.x = r.get<std::int32_t>();
+    p.y = r.get<std::int32_t>();
+    p.z = r.get<std::int32_t>();
+    return p;
+}
+
+void put_points(BinaryWriter& w, Span<const Point> v) {
+    w.put<std::uint32_t>(static_cast<std::uint32_t>(v.size()));
+    for (auto& p : v) put_point(w, p);
+}
+
+// Read a counted point list into the net's CSR slots; returns the count.
+// A tile point must index the routing grid; snapshots are untrusted input.
+Point get_grid_point(BinaryReader& r, const IspdData& data) {
+    auto p = get_point(r);
+    if (p.x < 0 || p.x >= data.numXGrid || p.y < 0 || p.y >= data.numYGrid || p.z < 0 || p.z >= data.numLayer)
+        throw std::runtime_error("snapshot: point outside the grid");
+    return p;
+}
+
+int get_points(BinaryReader& r, const IspdData& data, Point* out, int capacity) {
+    auto n = r.get_count<std::uint32_t>(kPointBytes);
+    if (n > static_cast<std::size_t>(capacity)) throw std::runtime_error("snapshot: corrupt pin list");
+    for (std::size_t i = 0; i < n; i++) out[i] = get_grid_point(r, data);
+    return static_cast<int>(n);
+}
+
+}  // namespace
+
+void save_snapshot(const IspdData& data, const std::string& path) {
+    BinaryWriter w;
+    w.put_array(kMagic, sizeof(kMagic));
+    w.put<std::uint32_t>(kVersion);
+    w.put<std::uint32_t>(data.decomposed ? kFlagDecomposed : 0u);
+
+    for (int v : {data.numXGrid, data.numYGrid, data.numLayer,
+                  data.lowerLeftX, data.lowerLeftY, data.tileWidth, data.tileHeight,
+                  data.numNet, data.numCapacityAdj})
+        w.put<std::int32_t>(v);
+    w.put_vector(data.verticalCapacity);
+    w.put_vector(data.horizontalCapacity);
+    w.put_vector(data.minimumWidth);
+    w.put_vector(data.minimumSpacing);
+    w.put_vector(data.viaSpacing);
+
+    w.put<std::uint64_t>(data.capacityAdjs.size());
+    for (auto& adj : data.capacityAdjs) {
+        auto [x1, y1, z1] = adj.grid1;
+        auto [x2, y2, z2] = adj.grid2;
+        for (int v : {x1, y1, z1, x2, y2, z2, adj.reducedCapacityLevel})
+            w.put<std::int32_t>(v);
+    }
+
+    w.put<std::uint64_t>(data.nets.size());
+    for (auto& net : data.nets) {
+        w.put_string(net.name);
+        w.put<std::int32_t>(net.id);
+        w.put<std::int32_t>(net.numPins);
+        w.put<std::int32_t>(net.minimumWidth);
+        auto pins = data.pins(net);
+        w.put<std::uint32_t>(static_cast<std::uint32_t>(pins.size()));
+        for (auto& [x, y, z] : pins) {
+            w.put<std::int32_t>(x);
+            w.put<std::int32_t>(y);
+            w.put<std::int32_t>(z);
+        }
+        put_points(w, data.decomposed ? data.pin2D(net) : Span<const Point>{});
+        put_points(w, data.decomposed ? data.pin3D(net) : Span<const Point>{});
+        w.put<std::uint32_t>(static_cast<std::uint32_t>(net.twopin.size()));
+        for (auto& tp : net.twopin) {
+            put_point(w, tp.from);
+            put_point(w, tp.to);
+        }
+    }
+    w.write_file(path);
+}
+
+IspdData load_snapshot(const std::string& path) {
+    MappedFile file(path);
+    BinaryReader r(file.data(), file.size(), "snapshot");
+
+    char magic[sizeof(kMagic)];
+    r.get_array(magic, sizeof(magic));
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("not a VLSIGR snapshot: " + path);
+    auto version = r.get<std::uint32_t>();
+    if (version != kVersion)
+        throw std::runtime_error("unsupported snapshot version " + std::to_string(version) + ": " + path);
+    auto flags = r.get<std::uint32_t>();
+
+    IspdData data;
+    for (int* v : {&data.numXGrid, &data.numYGrid, &data.numLayer,
+                   &data.lowerLeftX, &data.lowerLeftY, &data.tileWidth, &data.tileHeight,
+                   &data.numNet, &data.numCapacityAdj})
+        *v = r.get<std::int32_t>();
+    if (data.numXGrid <= 0 || data.numYGrid <= 0 || data.numLayer <= 0 || data.tileWidth <= 0 || data.tileHeight <= 0)
+        throw std::runtime_error("snapshot: grid and tile sizes must be positive");
+    r.get_vector(data.verticalCapacity);
+    r.get_vector(data.horizontalCapacity);
+    r.get_vector(data.minimumWidth);
+    r.get_vector(data.minimumSpacing);
+    r.get_vector(data.viaSpacing);
+    for (auto* v : {&data.verticalCapacity, &data.horizontalCapacity, &data.minimumWidth,
+                    &data.minimumSpacing, &data.viaSpacing})
+        if (v->size() != static_cast<std::size_t>(data.numLayer))
+            throw std::runtime_error("snapshot: per-layer values do not match the layer count");
+
+    // Every count is checked against the bytes left before it sizes anything.
+    auto nadj = r.get_count<std::uint64_t>(kAdjBytes);
+    data.capacityAdjs.reserve(nadj);
+    for (std::size_t i = 0; i < nadj; i++) {
+        int v[7];
+        for (auto& x : v) x = r.get<std::int32_t>();
+        data.capacityAdjs.push_back(CapacityAdj{{v[0], v[1], v[2]}, {v[3], v[4], v[5]}, v[6]});
+    }
+
+    data.nets.resize(r.get_count<std::uint64_t>(kNetMinBytes));
+    for (auto& net : data.nets) {
+        net.name = r.get_string();
+        net.id = r.get<std::int32_t>();
+        net.numPins = r.get<std::int32_t>();
+        net.minimumWidth = r.get<std::int32_t>();
+        auto npin = r.get_count<std::uint32_t>(kPinBytes);
+        net.pin_begin = data.pin_coords.size();
+        net.pin_count = static_cast<int>(npin);
+        for (std::size_t i = 0; i < npin; i++) {
+            int x = r.get<std::int32_t>();
+            int y = r.get<std::int32_t>();
+            int z = r.get<std::int32_t>();
+            if (!data.inside_die(x, y, z)) throw std::runtime_error("snapshot: pin lies outside the die");
+            data.pin_coords.emplace_back(x, y, z);
+        }
+        data.pin2D_coords.resize(data.pin_coords.size());
+        data.pin3D_coords.resize(data.pin_coords.size());
+        net.pin2D_count = get_points(r, data, data.pin2D_coords.data() + net.pin_begin, net.pin_count);
+        net.pin3D_count = get_points(r, data, data.pin3D_coords.data() + net.pin_begin, net.pin_count);
+        net.twopin.resize(r.get_count<std::uint32_t>(2 * kPointBytes));
+        for (auto& tp : net.twopin) {
+            tp.from = get_grid_point(r, data);
+            tp.to = get_grid_point(r, data);
+        }
+    }
+    if (!r.at_end()) throw std::runtime_error("snapshot has trailing data: " + path);
+    data.decomposed = (flags & kFlagDecomposed) != 0;
+    return data;
+}
+
+bool is_snapshot_file(const std::string& path) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    char magic[sizeof(kMagic)];
+    bool ok = std::fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+              std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    std::fclose(fp);
+    return ok;
+}
+
+}  // namespace vlsigr
@@ -0,0 +1,25 @@
+#pragma once
+
+// Versioned binary snapshot of a parsed (and usually decomposed) design.
+// Holds everything RoutingCore needs before routing starts: header fields,
+// capacity adjustments, raw pins, pin2D/pin3D and the two-pin decomposition.
+// Routed paths are not stored. Files are native-endian and meant to be
+// reused on the machine that wrote them.
+
+#include <string>
+
+#include "router/ispd_data.hpp"
+
+namespace vlsigr {
+
+// Write data to path; throws std::runtime_error on I/O failure.
+void save_snapshot(const IspdData& data, const std::string& path);
+
+// Load a snapshot written by save_snapshot (one mmap, one decode pass).
+// Throws std::runtime_error on a bad magic, unsupported version or truncation.
+IspdData load_snapshot(const std::string& path);
+
+// True if path starts with the snapshot magic.
+bool is_snapshot_file(const std::string& path);
+
+}  // namespace vlsigr
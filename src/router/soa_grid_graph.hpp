@@ -0,0 +1,109 @@
+#pragma once
+
+// Structure-of-arrays counterpart of GridGraph<Edge> for the routing hot path,
+// numbered by the same Layout (see grid_graph.hpp). Edge costs, history and the usage
+// counters live in separate contiguous arrays: the search kernels (HUM,
+// pattern routing) read only costs, so a sweep touches one EdgeCost per edge
+// (8 bytes, 4 with CostType=fixed) instead of a whole Edge. cap/demand/used/of stay together because
+// ripup/place and the overflow checks always touch them as a group.
+
+#include <cstddef>
+#include <vector>
+
+#include "router/cost_model.hpp"
+#include "router/grid_graph.hpp"
+#include "router/segment_path.hpp"
+
+namespace vlsigr {
+
+template<typename Layout = GridLayout, typename Access = UncheckedAccess>
+class BasicSoAGridGraph : public Layout {
+public:
+    struct Usage { int cap, demand, used, of; };
+
+private:
+    std::vector<Usage> use_;
+    std::vector<int> he_;
+    std::vector<EdgeCost> cost_;
+
+    using Line = typename Layout::Line;
+
+public:
+    std::size_t size() const { return cost_.size(); }
+
+    // Edge index of (x, y, hori), checked per Access (see grid_graph.hpp).
+    std::size_t index(int x, int y, bool hori) const {
+        Access::check(this->contains(x, y, hori));
+        return this->rp2idx(x, y, hori);
+    }
+
+    // Edge fields by index; see Edge.
+    int& cap(std::size_t i) { return use_[i].cap; }
+    int cap(std::size_t i) const { return use_[i].cap; }
+    int& demand(std::size_t i) { return use_[i].demand; }
+    int demand(std::size_t i) const { return use_[i].demand; }
+    int& he(std::size_t i) { return he_[i]; }
+    int he(std::size_t i) const { return he_[i]; }
+    int& of(std::size_t i) { return use_[i].of; }
+    int of(std::size_t i) const { return use_[i].of; }
+    int& used(std::size_t i) { return use_[i].used; }
+    int used(std::size_t i) const { return use_[i].used; }
+    EdgeCost& cost(std::size_t i) { return cost_[i]; }
+    EdgeCost cost(std::size_t i) const { return cost_[i]; }
+    bool overflow(std::size_t i) const { return use_[i].cap < use_[i].demand; }
+
+    EdgeCost cost(int x, int y, bool hori) const { return cost_[index(x, y, hori)]; }
+
+    // Costs of the horizontal edges of row y (by x) / vertical edges of column x (by y).
+    EdgeLine<const EdgeCost, Line> row_cost(int y) const {
+        Access::check(y >= 0 && static_cast<std::size_t>(y) < this->height());
+        return {cost_.data(), this->line(true, y)};
+    }
+    EdgeLine<const EdgeCost, Line> col_cost(int x) const {
+        Access::check(x >= 0 && static_cast<std::size_t>(x) < this->width());
+        return {cost_.data(), this->line(false, x)};
+    }
+
+    // Slots of path run s by along coordinate (s.along() to s.last()), checked per Access.
+    Line run(const PathSegment& s) const {
+        Access::check(this->contains(s.x, s.y, s.hori) &&
+                      (s.hori ? this->contains(s.last(), s.y, true) : this->contains(s.x, s.last(), false)));
+        return this->line(s.hori, s.across());
+    }
+
+    // Whole arrays by edge index, for batch kernels (CostModel::build_cost).
+    const Usage* usage_data() const { return use_.data(); }
+    const int* he_data() const { return he_.data(); }
+    EdgeCost* cost_data() { return cost_.data(); }
+    // Exchange the cost array with costs, which must hold size() entries.
+    void swap_costs(std::vector<EdgeCost>& costs) { cost_.swap(costs); }
+
+    // Gather / scatter one edge (checkpoints, tests).
+    Edge edge(std::size_t i) const {
+        Edge e(use_[i].cap);
+        e.demand = use_[i].demand;
+        e.he = he_[i];
+        e.of = use_[i].of;
+        e.used = use_[i].used;
+        e.cost = cost_[i];
+        return e;
+    }
+    void set_edge(std::size_t i, const Edge& e) {
+        use_[i] = {e.cap, e.demand, e.used, e.of};
+        he_[i] = e.he;
+        cost_[i] = e.cost;
+    }
+
+    void init(std::size_t width, std::size_t height, const Edge& vInit, const Edge& hInit) {
+        this->reset(width, height);
+        auto n = this->num_slots();
+        use_.assign(n, {hInit.cap, hInit.demand, hInit.used, hInit.of});
+        he_.assign(n, hInit.he);
+        cost_.assign(n, hInit.cost);
+        for (std::size_t i = 0; i < this->hori_begin(); i++) set_edge(i, vInit);
+    }
+};
+
+using SoAGridGraph = BasicSoAGridGraph<>;
+
+}  // namespace vlsigr
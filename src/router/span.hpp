@@ -0,0 +1,30 @@
+#pragma once
+
+// Non-owning view of a contiguous run of elements (a C++17 stand-in for std::span).
+
+#include <cstddef>
+
+namespace vlsigr {
+
+template<typename T>
+class Span {
+public:
+    Span() = default;
+    Span(T* data, std::size_t size): data_(data), size_(size) {}
+
+    T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](std::size_t i) const { return data_[i]; }
+    T& front() const { return data_[0]; }
+    T& back() const { return data_[size_ - 1]; }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace vlsigr
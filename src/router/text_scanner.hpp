@@ -0,0 +1,141 @@
+#pragma once
+
+// Minimal whitespace tokenizer over a contiguous byte range.
+// Used by the ISPD parser in place of std::istream >> so that large inputs
+// can be scanned straight out of an mmap or a caller-supplied buffer.
+// With a ChunkSource attached it also scans a sequence of blocks (e.g. a
+// decompressor's output); tokens may straddle block boundaries.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace vlsigr {
+
+// Producer of consecutive input blocks. A block stays valid until the next call.
+class ChunkSource {
+public:
+    virtual ~ChunkSource() = default;
+    // Set [begin, end) to the next non-empty block; false once the input is exhausted.
+    virtual bool next(const char*& begin, const char*& end) = 0;
+};
+
+class TextScanner {
+public:
+    TextScanner() = default;
+    TextScanner(const char* begin, const char* end): p_(begin), end_(end) {}
+    explicit TextScanner(ChunkSource& src): src_(&src) {}
+
+    // pos()/end()/seek() address the current block only; they are meant for
+    // contiguous input (see streaming()).
+    const char* pos() const { return p_; }
+    const char* end() const { return end_; }
+    void seek(const char* p) { p_ = p; }
+    bool at_end() { return !more(); }
+    bool streaming() const { return src_ != nullptr; }
+
+    // Same character class as std::isspace in the "C" locale.
+    static bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    void skip_ws() {
+        while (more() && is_space(*p_)) ++p_;
+    }
+
+    // Discard everything up to and including the next '\n' (istream::ignore equivalent).
+    void skip_line() {
+        while (more()) {
+            auto nl = static_cast<const char*>(std::memchr(p_, '\n', static_cast<std::size_t>(end_ - p_)));
+            if (nl) {
+                p_ = nl + 1;
+                return;
+            }
+            p_ = end_;
+        }
+    }
+
+    // Read a signed decimal integer; returns false on missing digits or int overflow.
+    bool read_int(int& out) {
+        skip_ws();
+        bool neg = false;
+        if (more() && (*p_ == '-' || *p_ == '+')) {
+            neg = (*p_ == '-');
+            ++p_;
+        }
+        bool any = false;
+        std::int64_t v = 0;
+        while (more()) {
+            unsigned d = static_cast<unsigned char>(*p_) - '0';
+            if (d > 9) break;
+            v = v * 10 + d;
+            if (v > static_cast<std::int64_t>(std::numeric_limits<int>::max()) + 1) return false;
+            ++p_;
+            any = true;
+        }
+        if (!any) return false;
+        if (neg) v = -v;
+        if (v > std::numeric_limits<int>::max() || v < std::numeric_limits<int>::min()) return false;
+        out = static_cast<int>(v);
+        return true;
+    }
+
+    // Read a whitespace-delimited token; returns false at end of input.
+    bool read_token(std::string& out) {
+        skip_ws();
+        out.clear();
+        while (more() && !is_space(*p_)) {
+            const char* b = p_;
+            while (p_ != end_ && !is_space(*p_)) ++p_;
+            out.append(b, p_);
+        }
+        return !out.empty();
+    }
+
+    // Step over a whitespace-delimited token; returns false at end of input.
+    bool skip_token() {
+        skip_ws();
+        bool any = false;
+        while (more() && !is_space(*p_)) {
+            ++p_;
+            any = true;
+        }
+        return any;
+    }
+
+    // Compare the next token against a literal without materializing it.
+    // On a mismatch the scanner position is unspecified (callers treat it as fatal).
+    bool expect_token(const char* lit) {
+        skip_ws();
+        while (*lit && more() && *p_ == *lit) { ++p_; ++lit; }
+        if (*lit) return false;
+        return !more() || is_space(*p_);
+    }
+
+private:
+    const char* p_ = nullptr;
+    const char* end_ = nullptr;
+    ChunkSource* src_ = nullptr;
+
+    // True if at least one byte is available, pulling the next block if needed.
+    bool more() {
+        if (p_ != end_) return true;
+        if (!src_) return false;
+        const char* b = nullptr;
+        const char* e = nullptr;
+        while (src_->next(b, e)) {
+            if (b != e) {
+                p_ = b;
+                end_ = e;
+                return true;
+            }
+        }
+        src_ = nullptr;
+        p_ = end_ = nullptr;
+        return false;
+    }
+};
+
+}  // namespace vlsigr
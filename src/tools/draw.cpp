@@ -14,6 +14,7 @@
 #include <queue>
 
 #include "router/ispd_data.hpp"
+#include "router/result_file.hpp"
 #include "tools/draw_api.hpp"
 
 namespace {
@@ -817,7 +818,12 @@ void render_from_files(const std::string& input_gr,
     // Parse ISPD input
     vlsigr::IspdData data;
     data = vlsigr::parse_ispd_file(input_gr);
+    render_from_result(data, input_out, opt);
+}
 
+void render_from_result(const vlsigr::IspdData& data,
+                        const std::string& input_out,
+                        const DrawOptions& opt) {
     const int X = data.numXGrid;
     const int Y = data.numYGrid;
     const int Z = data.numLayer;
@@ -874,49 +880,64 @@ void render_from_files(const std::string& input_gr,
         }
     }
 
-    // Accumulate demand from output.txt segments AND track net usage
-    std::ifstream fin(input_out);
-    if (!fin.is_open()) throw std::runtime_error("render_from_files: failed to open routing output");
-    while (!fin.eof()) {
-        std::string netname, line;
-        int id;
-        if (!(fin >> netname >> id)) break;
-        fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        while (std::getline(fin, line)) {
-            if (line == "!") break;
-            if (line.empty()) continue;
-            auto [x1r, y1r, z1, x2r, y2r, z2] = parse_segment(line);
-            int x1 = (x1r - data.lowerLeftX) / data.tileWidth;
-            int y1 = (y1r - data.lowerLeftY) / data.tileHeight;
-            int x2 = (x2r - data.lowerLeftX) / data.tileWidth;
-            int y2 = (y2r - data.lowerLeftY) / data.tileHeight;
-            int z = z1 - 1;
-            int zt = z2 - 1;
-            if (z != zt) {
-                node_nets[{x1, y1}].insert(id);
-                node_nets[{x2, y2}].insert(id);
-                continue;
+    // Accumulate demand from the routed wires (grid coordinates) AND track net usage
+    auto add_via = [&](int x, int y, int id) { node_nets[{x, y}].insert(id); };
+    auto add_wire = [&](int x1, int y1, int x2, int y2, int z, int id) {
+        if (x1 == x2 && y1 == y2) return;
+        if (z < 0 || z >= Z) return;
+        if (y1 == y2) {
+            if (x1 > x2) std::swap(x1, x2);
+            for (int x = x1; x < x2; ++x) {
+                if (x < 0 || x >= X - 1 || y1 < 0 || y1 >= Y) continue;
+                horizontal[x][y1][z].demand++;
+                edge_nets[{x, y1, z, true}].insert(id);
+                node_nets[{x, y1}].insert(id);
+                node_nets[{x + 1, y1}].insert(id);
             }
-            if (x1 == x2 && y1 == y2) continue;
-            if (z < 0 || z >= Z) continue;
-            if (y1 == y2) {
-                if (x1 > x2) std::swap(x1, x2);
-                for (int x = x1; x < x2; ++x) {
-                    if (x < 0 || x >= X - 1 || y1 < 0 || y1 >= Y) continue;
-                    horizontal[x][y1][z].demand++;
-                    edge_nets[{x, y1, z, true}].insert(id);
-                    node_nets[{x, y1}].insert(id);
-                    node_nets[{x + 1, y1}].insert(id);
-                }
-            } else if (x1 == x2) {
-                if (y1 > y2) std::swap(y1, y2);
-                for (int y = y1; y < y2; ++y) {
-                    if (x1 < 0 || x1 >= X || y < 0 || y >= Y - 1) continue;
-                    vertical[x1][y][z].demand++;
-                    edge_nets[{x1, y, z, false}].insert(id);
-                    node_nets[{x1, y}].insert(id);
-                    node_nets[{x1, y + 1}].insert(id);
+        } else if (x1 == x2) {
+            if (y1 > y2) std::swap(y1, y2);
+            for (int y = y1; y < y2; ++y) {
+                if (x1 < 0 || x1 >= X || y < 0 || y >= Y - 1) continue;
+                vertical[x1][y][z].demand++;
+                edge_nets[{x1, y, z, false}].insert(id);
+                node_nets[{x1, y}].insert(id);
+                node_nets[{x1, y + 1}].insert(id);
+            }
+        }
+    };
+
+    if (vlsigr::is_result_file(input_out)) {
+        // Binary result: mmapped arrays, already in grid coordinates.
+        vlsigr::ResultFile result(input_out);
+        const auto& h = result.header();
+        if (h.num_x_grid != X || h.num_y_grid != Y || h.num_layer != Z)
+            throw std::runtime_error("render_from_files: routing result does not match the design grid");
+        for (const auto& net : result.nets()) {
+            for (const auto& sg : result.segments(net)) add_wire(sg.x1, sg.y1, sg.x2, sg.y2, sg.z, net.id);
+            for (const auto& v : result.vias(net)) add_via(v.x, v.y, net.id);
+        }
+    } else {
+        std::ifstream fin(input_out);
+        if (!fin.is_open()) throw std::runtime_error("render_from_files: failed to open routing output");
+        while (!fin.eof()) {
+            std::string netname, line;
+            int id;
+            if (!(fin >> netname >> id)) break;
+            fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            while (std::getline(fin, line)) {
+                if (line == "!") break;
+                if (line.empty()) continue;
+                auto [x1r, y1r, z1, x2r, y2r, z2] = parse_segment(line);
+                int x1 = (x1r - data.lowerLeftX) / data.tileWidth;
+                int y1 = (y1r - data.lowerLeftY) / data.tileHeight;
+                int x2 = (x2r - data.lowerLeftX) / data.tileWidth;
+                int y2 = (y2r - data.lowerLeftY) / data.tileHeight;
+                if (z1 != z2) {
+                    add_via(x1, y1, id);
+                    add_via(x2, y2, id);
+                    continue;
                 }
+                add_wire(x1, y1, x2, y2, z1 - 1, id);
             }
         }
     }
@@ -1133,11 +1154,22 @@ void generate_map_from_data(const vlsigr::IspdData& data, const std::string& out
 
 #ifndef VLSIGR_DRAW_LIBRARY
 int main(int argc, char* argv[]) {
+    if (argc == 4 && std::string(argv[1]) == "--result-to-text") {
+        // Binary result -> output.txt, e.g. for eval2008.pl.
+        try {
+            vlsigr::ResultFile(argv[2]).write_text(argv[3]);
+        } catch (const std::exception& e) {
+            std::cerr << "draw failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
     if (argc < 4) {
-        std::cerr << "Usage: " << argv[0] << " <input.gr> <output.txt> <map.txt> [image.ppm]"
+        std::cerr << "Usage: " << argv[0] << " <input.gr> <output.txt|result.vgr> <map.txt> [image.ppm]"
                   << " [--overflow overflow.ppm] [--overflow-show-blockages]"
                   << " [--overflow-x-size N]"
-                  << " [--layers dir] [--stats stats.txt] [--nets nets.ppm] [--scale N]\n";
+                  << " [--layers dir] [--stats stats.txt] [--nets nets.ppm] [--scale N]\n"
+                  << "       " << argv[0] << " --result-to-text <result.vgr> <output.txt>\n";
         return 1;
     }
     std::string in_gr = argv[1];
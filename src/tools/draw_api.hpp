@@ -22,11 +22,18 @@ struct DrawOptions {
     int scale = 1;
 };
 
-// File-based render (same as the draw CLI, but callable).
+// File-based render (same as the draw CLI, but callable). input_out is either
+// the text output.txt or a binary result file (router --result-bin), detected
+// by its magic; the binary form is mmapped and read without parsing.
 void render_from_files(const std::string& input_gr,
                        const std::string& input_out,
                        const DrawOptions& opt);
 
+// Same as render_from_files for a design that is already loaded.
+void render_from_result(const vlsigr::IspdData& data,
+                        const std::string& input_out,
+                        const DrawOptions& opt);
+
 // In-memory render (for API integration without output.txt).
 void render_from_data(const vlsigr::IspdData& data,
                       const DrawOptions& opt);
@@ -1,13 +1,21 @@
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <regex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "api/vlsigr.hpp"
+#include "router/result_file.hpp"
+#include "router/utils.hpp"
 
 namespace {
 
@@ -16,6 +24,11 @@ std::string repo_path(const std::string& rel) {
     return rel;
 }
 
+std::string read_file(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
 }  // namespace
 
 TEST(ApiSmoke, LoadAndRouteComplex) {
@@ -67,6 +80,133 @@ TEST(ApiSmoke, InitThenRoute) {
     EXPECT_NE(router.getResults().data, nullptr);
 }
 
+TEST(ApiSmoke, SnapshotRerunMatchesTextInput) {
+    const std::string gr = repo_path("examples/complex.gr");
+    if (!std::filesystem::exists(gr)) {
+        GTEST_SKIP() << "Missing test input: " << gr;
+    }
+    const std::string snap = (std::filesystem::temp_directory_path() / "vlsigr_api.snap").string();
+
+    vlsigr::GlobalRouter cold;
+    cold.load_ispd_benchmark(gr);
+    ASSERT_NO_THROW(cold.save_snapshot(snap));
+    vlsigr::rng.seed(0);
+    ASSERT_NO_THROW(cold.route(""));
+
+    vlsigr::GlobalRouter warm;
+    ASSERT_NO_THROW(warm.load_snapshot(snap));
+    EXPECT_TRUE(warm.data().decomposed);
+    vlsigr::rng.seed(0);
+    ASSERT_NO_THROW(warm.route(""));
+
+    ASSERT_EQ(cold.data().nets.size(), warm.data().nets.size());
+    for (std::size_t i = 0; i < cold.data().nets.size(); i++) {
+        const auto& a = cold.data().nets[i].twopin;
+        const auto& b = warm.data().nets[i].twopin;
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t j = 0; j < a.size(); j++) EXPECT_EQ(a[j].path.size(), b[j].path.size());
+    }
+    EXPECT_EQ(cold.getPerformanceMetrics().wirelength_2d, warm.getPerformanceMetrics().wirelength_2d);
+
+    std::error_code ec;
+    std::filesystem::remove(snap, ec);
+}
+
+TEST(ApiSmoke, BinaryResultMatchesTextOutput) {
+    const std::string gr = repo_path("examples/complex.gr");
+    if (!std::filesystem::exists(gr)) {
+        GTEST_SKIP() << "Missing test input: " << gr;
+    }
+    const auto tmp = std::filesystem::temp_directory_path();
+    const std::string txt = (tmp / "vlsigr_result.txt").string();
+    const std::string bin = (tmp / "vlsigr_result.vgr").string();
+    const std::string back = (tmp / "vlsigr_result_back.txt").string();
+
+    vlsigr::GlobalRouter router;
+    ASSERT_NO_THROW(router.load_ispd_benchmark(gr));
+    ASSERT_NO_THROW(router.route(txt, bin));
+
+    ASSERT_TRUE(vlsigr::is_result_file(bin));
+    EXPECT_FALSE(vlsigr::is_result_file(txt));
+    vlsigr::ResultFile result(bin);
+    EXPECT_EQ(result.header().num_x_grid, router.data().numXGrid);
+    EXPECT_EQ(result.header().num_y_grid, router.data().numYGrid);
+    EXPECT_EQ(result.nets().size(), router.data().nets.size());
+    ASSERT_NO_THROW(result.write_text(back));
+    EXPECT_EQ(read_file(txt), read_file(back));
+
+    std::error_code ec;
+    std::filesystem::remove(txt, ec);
+    std::filesystem::remove(bin, ec);
+    std::filesystem::remove(back, ec);
+}
+
+TEST(ResultFile, RejectsWrappedNetRanges) {
+    const std::string bin = (std::filesystem::temp_directory_path() / "vlsigr_wrapped.vgr").string();
+    std::vector<vlsigr::ResultChunk> chunks(1);
+    chunks[0].add_net("n0", 0);
+    chunks[0].add_segment({0, 0, 1, 0, 0});
+    vlsigr::write_result_file(bin, vlsigr::ResultHeader{}, chunks);
+    ASSERT_NO_THROW(vlsigr::ResultFile{bin});
+
+    // segment_begin + segment_count wraps to 0, inside num_segments.
+    std::string bytes = read_file(bin);
+    const std::uint64_t begin = ~std::uint64_t(0);
+    std::memcpy(&bytes[sizeof(vlsigr::ResultHeader) + offsetof(vlsigr::ResultNet, segment_begin)], &begin,
+                sizeof(begin));
+    std::ofstream(bin, std::ios::binary) << bytes;
+    EXPECT_THROW(vlsigr::ResultFile{bin}, std::runtime_error);
+
+    std::error_code ec;
+    std::filesystem::remove(bin, ec);
+}
+
+TEST(ApiSmoke, ShortWriteOfTextOutputThrows) {
+    const std::string gr = repo_path("examples/complex.gr");
+    if (!std::filesystem::exists(gr) || !std::filesystem::exists("/dev/full")) {
+        GTEST_SKIP() << "Missing test input or /dev/full";
+    }
+    vlsigr::GlobalRouter router;
+    ASSERT_NO_THROW(router.load_ispd_benchmark(gr));
+    EXPECT_THROW(router.route("/dev/full"), std::runtime_error);
+}
+
+TEST(ApiSmoke, UnopenableTextOutputThrows) {
+    const std::string gr = repo_path("examples/complex.gr");
+    if (!std::filesystem::exists(gr)) {
+        GTEST_SKIP() << "Missing test input: " << gr;
+    }
+    const auto missing = std::filesystem::temp_directory_path() / "vlsigr_no_such_dir" / "out.txt";
+    vlsigr::GlobalRouter router;
+    ASSERT_NO_THROW(router.load_ispd_benchmark(gr));
+    EXPECT_THROW(router.route(missing.string()), std::runtime_error);
+}
+
+TEST(ApiSmoke, RouteEcoAfterRoute) {
+    const std::string gr = repo_path("examples/complex.gr");
+    if (!std::filesystem::exists(gr)) {
+        GTEST_SKIP() << "Missing test input: " << gr;
+    }
+
+    vlsigr::NetlistDelta delta;
+    delta.removed.push_back("n0");
+    delta.added.push_back({"eco0", 100, 1, {{1, 22, 1}, {22, 1, 1}}});
+
+    vlsigr::GlobalRouter router;
+    ASSERT_NO_THROW(router.load_ispd_benchmark(gr));
+    EXPECT_THROW(router.route_eco(delta), std::runtime_error);
+    ASSERT_NO_THROW(router.route(""));
+    auto nets = router.data().nets.size();
+
+    vlsigr::EcoStats st;
+    ASSERT_NO_THROW(st = router.route_eco(delta));
+    EXPECT_EQ(st.removed, 1);
+    EXPECT_EQ(st.added, 1);
+    EXPECT_EQ(router.data().nets.size(), nets);
+    EXPECT_EQ(router.data().nets.back().name, "eco0");
+    EXPECT_GE(router.getPerformanceMetrics().wirelength_2d, 1);
+}
+
 TEST(ApiSmoke, GenerateMapComplex) {
     const std::string gr = repo_path("examples/complex.gr");
     if (!std::filesystem::exists(gr)) {
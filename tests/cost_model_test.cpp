@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
 #include "router/cost_model.hpp"
 #include "router/grid_graph.hpp"
+#include "router/soa_grid_graph.hpp"
 
 using namespace vlsigr;
 
@@ -28,4 +33,78 @@ TEST(CostModel, BuildCostOnGrid) {
     EXPECT_NEAR(vcost, hcost, 1e-6);
 }
 
+TEST(CostModel, SoAGridMatchesGridGraph) {
+    GridGraph<Edge> aos;
+    SoAGridGraph soa;
+    aos.init(4, 3, Edge(2), Edge(3));
+    soa.init(4, 3, Edge(2), Edge(3));
+    ASSERT_EQ(soa.size(), aos.size());
+    for (std::size_t i = 0; i < aos.size(); i++) {
+        aos[i].demand = static_cast<int>(i % 5);
+        aos[i].he = 1 + static_cast<int>(i % 3);
+        soa.set_edge(i, aos[i]);
+    }
+    EXPECT_EQ(soa.index(3, 1, false), aos.rp2idx(3, 1, false));
+    EXPECT_EQ(soa.index(2, 2, true), aos.rp2idx(2, 2, true));
+    BasicSoAGridGraph<GridLayout, CheckedAccess> checked;
+    checked.init(4, 3, Edge(2), Edge(3));
+    EXPECT_EQ(checked.index(2, 2, true), soa.index(2, 2, true));
+    EXPECT_THROW(checked.index(3, 2, true), std::out_of_range);
+    EXPECT_THROW(checked.row_cost(3), std::out_of_range);
+
+    CostModel cm(2);
+    cm.build_cost(aos);
+    cm.build_cost(soa);
+    for (std::size_t i = 0; i < aos.size(); i++) {
+        auto e = soa.edge(i);
+        EXPECT_EQ(e.cap, aos[i].cap);
+        EXPECT_EQ(e.demand, aos[i].demand);
+        EXPECT_EQ(soa.overflow(i), aos[i].overflow());
+        EXPECT_EQ(e.cost, aos[i].cost);
+    }
+}
+
+TEST(CostModel, BatchBuildMatchesCalcCost) {
+    // Large enough to be split into chunks; history runs past the table and
+    // overflow past both ends of the penalty table.
+    SoAGridGraph grid;
+    grid.init(300, 300, Edge(4), Edge(6));
+    for (std::size_t i = 0; i < grid.size(); i++) {
+        grid.demand(i) = static_cast<int>(i * 7 % 1500) - 200;
+        grid.he(i) = static_cast<int>(i * 13 % (CostModel::HISTSZ + 100));
+    }
+    for (int sel = 0; sel < 3; sel++) {
+        CostModel cm(sel);
+        cm.build_cost(grid);
+        for (std::size_t i = 0; i < grid.size(); i++)
+            ASSERT_EQ(grid.cost(i), cm.edge_cost(grid.demand(i), grid.cap(i), grid.he(i))) << "edge " << i;
+    }
+    // The tabulated history term is the legacy pow() inside and outside the table.
+    CostModel cm(2);
+    double pe = 1 + 200.0 / (1 + std::exp(-0.7 * 2));  // demand 5 + 1 - cap 4
+    for (int he : {37, CostModel::HISTSZ + 5})
+        EXPECT_EQ(cm.calc_cost(5, 4, he), (1 + std::pow(he, 3.6) / 100.0) * pe + 200.0);
+}
 
+TEST(CostModel, EdgeCostScalesAndSaturates) {
+    EXPECT_EQ(to_edge_cost(1.0), kCostScale);
+    EXPECT_EQ(cost_value(to_edge_cost(210.25)), 210.25);
+    EXPECT_EQ(cost_add(kCostInf, kCostScale), kCostInf);
+    if constexpr (std::is_integral_v<EdgeCost>) {
+        EXPECT_EQ(to_edge_cost(1e300), kCostInf);
+        EXPECT_EQ(to_edge_cost(std::nan("")), kCostInf);
+        EXPECT_EQ(to_edge_cost(2.5 / kCostScale), 2);  // nearest, ties to even
+        EXPECT_EQ(to_edge_cost(3.5 / kCostScale), 4);
+    }
+}
+
+TEST(CostModel, VisitDispatchesSelcostToPolicy) {
+    for (int sel = 0; sel < 3; sel++) {
+        CostModel cm(sel);
+        int seen = cm.visit([](const auto& m) { return std::decay_t<decltype(m)>::policy::selcost; });
+        EXPECT_EQ(seen, sel);
+    }
+    EXPECT_THROW(CostModel(3), std::runtime_error);
+    CostModel cm(1);
+    EXPECT_THROW(cm.set_selcost(-1), std::runtime_error);
+}
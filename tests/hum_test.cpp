@@ -1,23 +1,29 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "router/hum.hpp"
-#include "router/grid_graph.hpp"
+#include "router/box_cost.hpp"
 #include "router/cost_model.hpp"
+#include "router/min_plus.hpp"
+#include "router/soa_grid_graph.hpp"
 #include "router/patterns.hpp"
+#include "router/utils.hpp"
 
 using namespace vlsigr;
 
 namespace {
-void place_path(const TwoPin& tp, GridGraph<Edge>& grid) {
-    for (auto& rp : tp.path) {
-        grid.at(rp.x, rp.y, rp.hori).demand += 1;
+void place_path(const TwoPin& tp, SoAGridGraph& grid) {
+    for (const auto& rp : tp.path) {
+        grid.demand(grid.index(rp.x, rp.y, rp.hori)) += 1;
     }
 }
 }
 
 TEST(HUM, RelievesOverflow) {
     // 3x3 grid with very low capacity and a pre-blocked monotonic corridor.
-    GridGraph<Edge> grid;
+    SoAGridGraph grid;
     grid.init(3, 3, Edge(1), Edge(1));  // tight capacity
     CostModel cm(0);
 
@@ -27,10 +33,10 @@ TEST(HUM, RelievesOverflow) {
 
     // Pre-block the intuitive monotonic path along bottom row then up right edge:
     // (0,0)-(1,0)-(2,0)-(2,1)-(2,2)
-    grid.at(0, 0, true).demand += 1; // (0,0)->(1,0)
-    grid.at(1, 0, true).demand += 1; // (1,0)->(2,0)
-    grid.at(2, 0, false).demand += 1; // (2,0)->(2,1)
-    grid.at(2, 1, false).demand += 1; // (2,1)->(2,2)
+    grid.demand(grid.index(0, 0, true)) += 1; // (0,0)->(1,0)
+    grid.demand(grid.index(1, 0, true)) += 1; // (1,0)->(2,0)
+    grid.demand(grid.index(2, 0, false)) += 1; // (2,0)->(2,1)
+    grid.demand(grid.index(2, 1, false)) += 1; // (2,1)->(2,2)
 
     // First try the intuitive monotonic corridor and confirm it overflows:
     // (0,0)->(1,0)->(2,0)->(2,1)->(2,2)
@@ -43,22 +49,66 @@ TEST(HUM, RelievesOverflow) {
     };
     place_path(monotonic_tp, grid);
     bool mono_overflow = false;
-    for (auto& rp : monotonic_tp.path) {
-        if (grid.at(rp.x, rp.y, rp.hori).overflow()) { mono_overflow = true; break; }
+    for (const auto& rp : monotonic_tp.path) {
+        if (grid.overflow(grid.index(rp.x, rp.y, rp.hori))) { mono_overflow = true; break; }
     }
     EXPECT_TRUE(mono_overflow);
     // reset demands
-    for (auto& rp : monotonic_tp.path) grid.at(rp.x, rp.y, rp.hori).demand -= 1;
+    for (const auto& rp : monotonic_tp.path) grid.demand(grid.index(rp.x, rp.y, rp.hori)) -= 1;
 
     // Run HUM and expect no overflow on touched edges
     // IMPORTANT: rebuild cost after modifying demands, otherwise HUM won't "see" congestion.
     cm.build_cost(grid);
-    hum::HUM(tp, grid, cm, grid.width(), grid.height());
+    auto box = hum::SearchBox::around(tp);
+    hum::HUM(tp, box, grid, cm, grid.width(), grid.height());
+    EXPECT_LE(box.L, std::min(tp.from.x, tp.to.x));
+    EXPECT_GE(box.U, std::max(tp.from.y, tp.to.y));
     place_path(tp, grid);
-    for (auto& rp : tp.path) {
-        auto& e = grid.at(rp.x, rp.y, rp.hori);
-        EXPECT_FALSE(e.overflow());
+    for (const auto& rp : tp.path) {
+        EXPECT_FALSE(grid.overflow(grid.index(rp.x, rp.y, rp.hori)));
     }
 }
 
-
+TEST(HUM, LineKernelsMatchScalar) {
+    // Runs of every length up to 40 in the middle row of a 3-row box, with
+    // unreached cells and edges near saturation: relax_run and extend_run
+    // (vectorized where the build has them) must match the scalar loops.
+    rng.seed(3);
+    BoxScratch fast_scratch, slow_scratch;
+    std::vector<EdgeCost> g;
+    auto random_cost = [] {
+        switch (randint<int>(0, 5)) {
+        case 0: return kCostInf;
+        case 1: return kCostInf - to_edge_cost(randint<int>(0, 4));
+        default: return to_edge_cost(randint<int>(0, 300));
+        }
+    };
+    for (int n = 1; n <= 40; n++) {
+        for (bool descending : {false, true}) {
+            BoxCost fast(5, 5 + n - 1, 0, 2, fast_scratch, BoxCost::kByRow);
+            BoxCost slow(5, 5 + n - 1, 0, 2, slow_scratch, BoxCost::kByRow);
+            g.resize(n);
+            for (auto& c : g) c = random_cost();
+            for (int x = 5; x < 5 + n; x++)
+                fast.cost(x, 0) = slow.cost(x, 0) = random_cost();
+            auto from = descending ? BoxCost::kUp : BoxCost::kDown;
+            extend_run(fast, fast.index(5, 1), fast.index(5, 0), n, g.data(), from);
+            extend_run_scalar(slow, slow.index(5, 1), slow.index(5, 0), n, g.data(), from);
+            for (int x = 5; x < 5 + n; x++)
+                if (randint<int>(0, 2) == 0) fast.cost(x, 1) = slow.cost(x, 1) = random_cost();
+            for (auto& c : g) c = random_cost();
+            auto d = descending ? BoxCost::kRight : BoxCost::kLeft;
+            relax_run(fast, fast.index(5, 1), n, g.data(), descending, d);
+            relax_run_scalar(slow, slow.index(5, 1), n, g.data(), descending, d);
+            for (int y = 0; y < 3; y++)
+                for (int x = 5; x < 5 + n; x++) {
+                    SCOPED_TRACE(testing::Message() << "n " << n << " descending " << descending << " cell " << x << "," << y);
+                    ASSERT_EQ(fast.cost(x, y), slow.cost(x, y));
+                    ASSERT_EQ(fast.reached(x, y), slow.reached(x, y));
+                    if (slow.reached(x, y)) {
+                        ASSERT_EQ(fast.from(x, y), slow.from(x, y));
+                    }
+                }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "LayerAssignment.h"
+#include "ThreadPool.h"
+
+TEST(LayerAssignment, ParallelWriterMatchesPrintf) {
+    // Three-node chain per net: pin - wire - wire - pin on layer 1, vias to layer 0
+    // at both pins. Enough nets for several writer chunks; extreme origins
+    // exercise the integer formatting.
+    LayerAssignment::Graph g;
+    g.xNum = 3;
+    g.yNum = 1;
+    g.cellW = 10;
+    g.cellH = 7;
+    g.blx = INT_MIN;
+    g.bly = -5;
+    const int n = 2500;
+    std::string expected;
+    char line[128];
+    for (int i = 0; i < n; i++) {
+        LayerAssignment::Net net(i * 37 - 1000);
+        net.name = "n" + std::to_string(i);
+        net.nodeArray.resize(3);
+        for (int j = 0; j < 3; j++) {
+            auto& nd = net.nodeArray[j];
+            nd.x = j;
+            nd.y = 0;
+            nd.degree = j < 2 ? 1 : 0;
+            nd.chiIndex[0] = j + 1;
+            nd.pin = (j != 1);
+            nd.pinMinLay = nd.pinMaxLay = 0;
+        }
+        net.edgeArray.resize(2);
+        for (int j = 0; j < 2; j++) {
+            net.edgeArray[j].x = j;
+            net.edgeArray[j].y = 0;
+            net.edgeArray[j].z = 1;
+            net.edgeArray[j].hori = 1;
+        }
+        g.netArray.push_back(net);
+
+        std::snprintf(line, sizeof(line), "%s %d\n", net.name.c_str(), net.netID);
+        expected += line;
+        std::snprintf(line, sizeof(line), "(%d,%d,%d)-(%d,%d,%d)\n", g.blx, g.bly, 2, 2 * g.cellW + g.blx, g.bly, 2);
+        expected += line;
+        for (int x : {0, 2}) {
+            std::snprintf(line, sizeof(line), "(%d,%d,%d)-(%d,%d,%d)\n",
+                          x * g.cellW + g.blx, g.bly, 1, x * g.cellW + g.blx, g.bly, 2);
+            expected += line;
+        }
+        expected += "!\n";
+    }
+
+    auto read = [](const std::string& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(ifs), {});
+    };
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto serial = (dir / "vlsigr_la_serial.txt").string();
+    const auto parallel = (dir / "vlsigr_la_parallel.txt").string();
+    ThreadPool pool(3);
+    g.output3Dresult(serial.c_str());
+    g.output3Dresult(parallel.c_str(), &pool);
+    EXPECT_EQ(read(serial), expected);
+    EXPECT_EQ(read(parallel), expected);
+    std::error_code ec;
+    std::filesystem::remove(serial, ec);
+    std::filesystem::remove(parallel, ec);
+}
@@ -1,12 +1,27 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "router/compressed_input.hpp"
 #include "router/ispd_data.hpp"
+#include "router/decomposition.hpp"
+#include "router/edge_set.hpp"
 #include "router/grid_graph.hpp"
+#include "router/snapshot.hpp"
 #include "router/utils.hpp"
 
+#ifdef VLSIGR_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 using namespace vlsigr;
 
 TEST(Parser, SmallMinimal) {
@@ -33,10 +48,11 @@ net0 0 2 1
     const auto& net = data.nets[0];
     EXPECT_EQ(net.name, "net0");
     EXPECT_EQ(net.numPins, 2);
-    ASSERT_EQ(net.pins.size(), 2u);
-    EXPECT_EQ(std::get<0>(net.pins[0]), 0);
-    EXPECT_EQ(std::get<1>(net.pins[0]), 0);
-    EXPECT_EQ(std::get<2>(net.pins[0]), 1);
+    auto pins = data.pins(net);
+    ASSERT_EQ(pins.size(), 2u);
+    EXPECT_EQ(std::get<0>(pins[0]), 0);
+    EXPECT_EQ(std::get<1>(pins[0]), 0);
+    EXPECT_EQ(std::get<2>(pins[0]), 1);
 }
 
 TEST(Parser, OfficialStyleSnippet) {
@@ -71,8 +87,12 @@ n2 2 2 1
     ASSERT_EQ(data.nets.size(), 2u);
     EXPECT_EQ(data.nets[0].name, "n1");
     EXPECT_EQ(data.nets[1].name, "n2");
-    EXPECT_EQ(data.nets[0].pins.size(), 2u);
-    EXPECT_EQ(std::get<0>(data.nets[0].pins[1]), 10);
+    EXPECT_EQ(data.pins(data.nets[0]).size(), 2u);
+    EXPECT_EQ(std::get<0>(data.pins(data.nets[0])[1]), 10);
+    // CSR store: nets occupy consecutive runs of one coordinate array.
+    EXPECT_EQ(data.pin_coords.size(), 4u);
+    EXPECT_EQ(data.nets[1].pin_begin, 2u);
+    EXPECT_EQ(std::get<1>(data.pins(data.nets[1])[0]), 10);
 
     EXPECT_EQ(data.numCapacityAdj, 1);
     ASSERT_EQ(data.capacityAdjs.size(), 1u);
@@ -83,6 +103,329 @@ n2 2 2 1
     EXPECT_EQ(adj.reducedCapacityLevel, 2);
 }
 
+namespace {
+
+template<typename T>
+std::vector<T> to_vector(Span<const T> s) {
+    return std::vector<T>(s.begin(), s.end());
+}
+
+void expect_same_data(const IspdData& a, const IspdData& b) {
+    EXPECT_EQ(a.numXGrid, b.numXGrid);
+    EXPECT_EQ(a.numYGrid, b.numYGrid);
+    EXPECT_EQ(a.numLayer, b.numLayer);
+    EXPECT_EQ(a.verticalCapacity, b.verticalCapacity);
+    EXPECT_EQ(a.horizontalCapacity, b.horizontalCapacity);
+    EXPECT_EQ(a.minimumWidth, b.minimumWidth);
+    EXPECT_EQ(a.minimumSpacing, b.minimumSpacing);
+    EXPECT_EQ(a.viaSpacing, b.viaSpacing);
+    EXPECT_EQ(a.lowerLeftX, b.lowerLeftX);
+    EXPECT_EQ(a.lowerLeftY, b.lowerLeftY);
+    EXPECT_EQ(a.tileWidth, b.tileWidth);
+    EXPECT_EQ(a.tileHeight, b.tileHeight);
+    EXPECT_EQ(a.numNet, b.numNet);
+    ASSERT_EQ(a.nets.size(), b.nets.size());
+    for (std::size_t i = 0; i < a.nets.size(); i++) {
+        EXPECT_EQ(a.nets[i].name, b.nets[i].name);
+        EXPECT_EQ(a.nets[i].id, b.nets[i].id);
+        EXPECT_EQ(a.nets[i].numPins, b.nets[i].numPins);
+        EXPECT_EQ(a.nets[i].minimumWidth, b.nets[i].minimumWidth);
+        EXPECT_EQ(to_vector(a.pins(a.nets[i])), to_vector(b.pins(b.nets[i])));
+    }
+    EXPECT_EQ(a.numCapacityAdj, b.numCapacityAdj);
+    ASSERT_EQ(a.capacityAdjs.size(), b.capacityAdjs.size());
+    for (std::size_t i = 0; i < a.capacityAdjs.size(); i++) {
+        EXPECT_EQ(a.capacityAdjs[i].grid1, b.capacityAdjs[i].grid1);
+        EXPECT_EQ(a.capacityAdjs[i].grid2, b.capacityAdjs[i].grid2);
+        EXPECT_EQ(a.capacityAdjs[i].reducedCapacityLevel, b.capacityAdjs[i].reducedCapacityLevel);
+    }
+}
+
+void expect_same_decomposition(const IspdData& a, const IspdData& b) {
+    ASSERT_EQ(a.nets.size(), b.nets.size());
+    auto same_points = [](const std::vector<Point>& p, const std::vector<Point>& q) {
+        if (p.size() != q.size()) return false;
+        for (std::size_t i = 0; i < p.size(); i++)
+            if (p[i].x != q[i].x || p[i].y != q[i].y || p[i].z != q[i].z) return false;
+        return true;
+    };
+    for (std::size_t i = 0; i < a.nets.size(); i++) {
+        const auto& na = a.nets[i];
+        const auto& nb = b.nets[i];
+        EXPECT_TRUE(same_points(to_vector(a.pin2D(na)), to_vector(b.pin2D(nb)))) << "net " << na.name;
+        EXPECT_TRUE(same_points(to_vector(a.pin3D(na)), to_vector(b.pin3D(nb)))) << "net " << na.name;
+        ASSERT_EQ(na.twopin.size(), nb.twopin.size());
+        for (std::size_t j = 0; j < na.twopin.size(); j++) {
+            EXPECT_TRUE(same_points({na.twopin[j].from, na.twopin[j].to},
+                                    {nb.twopin[j].from, nb.twopin[j].to}));
+        }
+    }
+}
+
+}  // namespace
+
+TEST(Parser, BufferMatchesStream) {
+    std::string input = R"(grid 3 2 2
+vertical capacity 4 6
+horizontal capacity 5 7
+minimum width 1 1
+minimum spacing 2 2
+via spacing 3 3
+-10 0 10 10
+num net 2
+n1 1 2 1
+-10 0 1
+10 0 2
+n2 2 2 1
+0 10 1
+10 10 1
+1
+0 0 1 1 0 1 2
+)";
+    std::istringstream iss(input);
+    auto ref = parse_ispd(iss);
+    auto fast = parse_ispd_buffer(input.data(), input.size());
+    expect_same_data(ref, fast);
+    EXPECT_EQ(std::get<0>(fast.pins(fast.nets[0])[0]), -10);
+}
+
+TEST(Parser, BufferMatchesStreamComplex) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    std::ifstream ifs(gr);
+    auto ref = parse_ispd(ifs);
+    auto fast = parse_ispd_file(gr);
+    expect_same_data(ref, fast);
+}
+
+TEST(Parser, ParallelNetsMatchSerial) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    ParseOptions serial;
+    serial.parallel_min_nets = 0;
+    ParseOptions parallel;
+    parallel.parallel_min_nets = 1;
+    parallel.nets_per_task = 3;
+    expect_same_data(parse_ispd_file(gr, serial), parse_ispd_file(gr, parallel));
+}
+
+TEST(Parser, ParallelFallsBackOnUnusualLayout) {
+    // Pins share the header line, so the line-based net index is wrong and
+    // the parser must fall back to the serial path.
+    std::string input = R"(grid 3 2 1
+vertical capacity 4
+horizontal capacity 5
+minimum width 1
+minimum spacing 2
+via spacing 3
+0 0 10 10
+num net 2
+n1 1 2 1 0 0 1 10 0 1
+n2 2 2 1
+0 10 1 10 10 1
+0
+)";
+    std::istringstream iss(input);
+    auto ref = parse_ispd(iss);
+    ParseOptions parallel;
+    parallel.parallel_min_nets = 1;
+    parallel.nets_per_task = 1;
+    expect_same_data(ref, parse_ispd_buffer(input.data(), input.size(), parallel));
+}
+
+TEST(Parser, BufferRejectsMalformed) {
+    std::string input = "grid 2 2 1\nvertical capacity x\n";
+    EXPECT_THROW(parse_ispd_buffer(input.data(), input.size()), std::runtime_error);
+    std::string truncated = "grid 2 2 1\nvertical capacity 10\nhorizontal capacity 20\n"
+                            "minimum width 1\nminimum spacing 1\nvia spacing 1\n0 0 10 10\n"
+                            "num net 1\nnet0 0 2 1\n0 0 1\n";
+    EXPECT_THROW(parse_ispd_buffer(truncated.data(), truncated.size()), std::runtime_error);
+}
+
+TEST(Parser, RejectsPinsOutsideTheDie) {
+    // 2x2 tiles of 10x10 from the origin: the die is [0, 20) x [0, 20), layer 1.
+    auto design = [](const std::string& pin) {
+        return "grid 2 2 1\nvertical capacity 10\nhorizontal capacity 20\nminimum width 1\n"
+               "minimum spacing 1\nvia spacing 1\n0 0 10 10\nnum net 1\nnet0 0 2 1\n0 0 1\n" +
+               pin + "\n0\n";
+    };
+    std::string ok = design("19 19 1");
+    EXPECT_NO_THROW(parse_ispd_buffer(ok.data(), ok.size()));
+    ParseOptions parallel;
+    parallel.parallel_min_nets = 1;
+    for (std::string pin : {"5000 5000 1", "40 23 1", "20 0 1", "-1 0 1", "0 0 0", "0 0 2"}) {
+        SCOPED_TRACE(pin);
+        std::string input = design(pin);
+        EXPECT_THROW(parse_ispd_buffer(input.data(), input.size()), std::runtime_error);
+        EXPECT_THROW(parse_ispd_buffer(input.data(), input.size(), parallel), std::runtime_error);
+        std::istringstream iss(input);
+        EXPECT_THROW(parse_ispd(iss), std::runtime_error);
+    }
+    std::string no_tiles = "grid 2 2 1\nvertical capacity 10\nhorizontal capacity 20\nminimum width 1\n"
+                           "minimum spacing 1\nvia spacing 1\n0 0 0 10\nnum net 0\n0\n";
+    EXPECT_THROW(parse_ispd_buffer(no_tiles.data(), no_tiles.size()), std::runtime_error);
+}
+
+namespace {
+
+// Hands out a buffer in fixed-size pieces so tokens straddle block boundaries.
+class SlicedSource : public ChunkSource {
+public:
+    SlicedSource(const std::string& s, std::size_t step): s_(s), step_(step) {}
+    bool next(const char*& begin, const char*& end) override {
+        if (off_ >= s_.size()) return false;
+        begin = s_.data() + off_;
+        off_ = std::min(s_.size(), off_ + step_);
+        end = s_.data() + off_;
+        return true;
+    }
+
+private:
+    const std::string& s_;
+    std::size_t step_;
+    std::size_t off_ = 0;
+};
+
+std::string read_file(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), {});
+}
+
+}  // namespace
+
+TEST(Parser, ChunkedInputMatchesBuffer) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto text = read_file(gr);
+    auto ref = parse_ispd_buffer(text.data(), text.size());
+    for (std::size_t step : {1, 3, 7, 4096}) {
+        SlicedSource src(text, step);
+        expect_same_data(ref, parse_ispd_chunks(src));
+    }
+    std::string bad = "grid 2 2 1\nvertical capacity x\n";
+    SlicedSource src(bad, 2);
+    EXPECT_THROW(parse_ispd_chunks(src), std::runtime_error);
+}
+
+#ifdef VLSIGR_HAVE_ZLIB
+TEST(Parser, GzipFileMatchesPlain) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto text = read_file(gr);
+    const auto path = (std::filesystem::temp_directory_path() / "vlsigr_complex.gr.gz").string();
+    // Two gzip members, split mid-line, like `cat a.gz b.gz`.
+    auto half = text.size() / 2;
+    for (int part = 0; part < 2; part++) {
+        gzFile gz = gzopen(path.c_str(), part == 0 ? "wb" : "ab");
+        ASSERT_NE(gz, nullptr);
+        auto b = part == 0 ? 0 : half;
+        auto n = part == 0 ? half : text.size() - half;
+        ASSERT_EQ(gzwrite(gz, text.data() + b, static_cast<unsigned>(n)), static_cast<int>(n));
+        gzclose(gz);
+    }
+
+    auto ref = parse_ispd_buffer(text.data(), text.size());
+    expect_same_data(ref, parse_ispd_file(path));
+
+    auto zipped = read_file(path);
+    ASSERT_EQ(detect_compression(zipped.data(), zipped.size()), Compression::Gzip);
+    DecompressingSource small(zipped.data(), zipped.size(), Compression::Gzip, 5, 2);
+    expect_same_data(ref, parse_ispd_chunks(small));
+
+    // Truncated archives are reported, not silently parsed short.
+    std::filesystem::resize_file(path, zipped.size() / 3);
+    EXPECT_THROW(parse_ispd_file(path), std::runtime_error);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+#endif
+
+TEST(Snapshot, RoundTripDecomposed) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto data = parse_ispd_file(gr);
+    prepare_nets(data);
+    const auto path = (std::filesystem::temp_directory_path() / "vlsigr_complex.snap").string();
+    save_snapshot(data, path);
+    ASSERT_TRUE(is_snapshot_file(path));
+    EXPECT_FALSE(is_snapshot_file(gr));
+
+    auto loaded = load_snapshot(path);
+    EXPECT_TRUE(loaded.decomposed);
+    expect_same_data(data, loaded);
+    expect_same_decomposition(data, loaded);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+TEST(Streaming, PreparedMatchesParseThenPrepare) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto ref = parse_ispd_file(gr);
+    prepare_nets(ref);
+
+    ParseOptions serial;
+    serial.parallel_min_nets = 0;
+    serial.nets_per_task = 2;
+    auto streamed = parse_ispd_file_prepared(gr, serial);
+    EXPECT_TRUE(streamed.decomposed);
+    expect_same_data(ref, streamed);
+    expect_same_decomposition(ref, streamed);
+
+    ParseOptions parallel;
+    parallel.parallel_min_nets = 1;
+    parallel.nets_per_task = 3;
+    auto streamed_par = parse_ispd_file_prepared(gr, parallel);
+    expect_same_data(ref, streamed_par);
+    expect_same_decomposition(ref, streamed_par);
+}
+
+namespace {
+
+// A one-tile, one-layer design with no nets; loads back as is.
+IspdData tiny_design() {
+    IspdData data;
+    data.numXGrid = data.numYGrid = data.numLayer = 1;
+    data.tileWidth = data.tileHeight = 1;
+    data.verticalCapacity = data.horizontalCapacity = {1};
+    data.minimumWidth = data.minimumSpacing = data.viaSpacing = {1};
+    return data;
+}
+
+}  // namespace
+
+TEST(Snapshot, RejectsTruncatedFile) {
+    auto data = tiny_design();
+    const auto path = (std::filesystem::temp_directory_path() / "vlsigr_trunc.snap").string();
+    save_snapshot(data, path);
+    EXPECT_NO_THROW(load_snapshot(path));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_THROW(load_snapshot(path), std::runtime_error);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+TEST(Snapshot, RejectsCountsBeyondTheFile) {
+    // Header: magic, version, flags, nine int32 fields; then the first
+    // per-layer vector's uint64 count. 5 vectors of one int32 later come the
+    // capacity adjustment and net counts.
+    const std::size_t first_vector = 8 + 4 + 4 + 9 * 4;
+    const std::size_t net_count = first_vector + 5 * (8 + 4) + 8;
+    const auto path = (std::filesystem::temp_directory_path() / "vlsigr_counts.snap").string();
+    // A count whose byte size wraps to 4, and one far past the file.
+    for (auto [offset, count] : {std::pair<std::size_t, std::uint64_t>{first_vector, (1ull << 62) + 1},
+                                 {net_count, 1ull << 40}}) {
+        save_snapshot(tiny_design(), path);
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(static_cast<std::streamoff>(offset));
+        f.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        f.close();
+        EXPECT_THROW(load_snapshot(path), std::runtime_error);
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
 TEST(GridGraph, Indexing) {
     struct Edge { int v = 0; };
     GridGraph<Edge> g;
@@ -99,6 +442,72 @@ TEST(GridGraph, Indexing) {
     EXPECT_EQ(g.at(1, 1, true).v, 2);
 }
 
+namespace {
+
+template<typename Layout>
+void expect_each_edge_numbered_once(std::size_t w, std::size_t h) {
+    SCOPED_TRACE(std::string(Layout::name) + " " + std::to_string(w) + "x" + std::to_string(h));
+    GridGraph<int, Layout> g;
+    g.init(w, h, 1, 2);
+    ASSERT_EQ(g.size(), g.num_slots());
+    std::vector<int> seen(g.num_slots(), 0);
+    for (int hori = 0; hori < 2; hori++)
+        for (int x = 0; x < static_cast<int>(w); x++)
+            for (int y = 0; y < static_cast<int>(h); y++) {
+                if (!g.contains(x, y, hori)) continue;
+                auto i = g.rp2idx(x, y, hori);
+                ASSERT_LT(i, g.num_slots());
+                EXPECT_EQ(seen[i]++, 0);
+                EXPECT_EQ(g[i], hori ? 2 : 1);
+                EXPECT_EQ(hori ? &g.row(y)[x] : &g.col(x)[y], &g[i]);
+                int rx, ry;
+                bool rh;
+                g.idx2rp(i, rx, ry, rh);
+                EXPECT_EQ(rx, x);
+                EXPECT_EQ(ry, y);
+                EXPECT_EQ(rh, hori != 0);
+            }
+    EXPECT_FALSE(g.contains(static_cast<int>(w) - 1, 0, true));
+    EXPECT_FALSE(g.contains(0, static_cast<int>(h) - 1, false));
+}
+
+TEST(GridGraph, CheckedAccessThrowsOutsideGrid) {
+    GridGraph<int, GridLayout, CheckedAccess> g;
+    g.init(3, 2, 1, 2);
+    EXPECT_EQ(g.at(1, 1, true), 2);
+    EXPECT_EQ(g.col(2)[0], 1);
+    EXPECT_THROW(g.at(2, 0, true), std::out_of_range);
+    EXPECT_THROW(g.at(0, 1, false), std::out_of_range);
+    EXPECT_THROW(g.at(-1, 0, true), std::out_of_range);
+    EXPECT_THROW(g.row(2), std::out_of_range);
+}
+
+}  // namespace
+
+TEST(GridGraph, LayoutsNumberEachEdgeOnce) {
+    const std::pair<std::size_t, std::size_t> dims[] = {{1, 5}, {5, 1}, {2, 2}, {13, 7}, {70, 3}, {64, 65}};
+    for (auto [w, h] : dims) {
+        expect_each_edge_numbered_once<WireLayout>(w, h);
+        expect_each_edge_numbered_once<TiledLayout<8>>(w, h);
+        expect_each_edge_numbered_once<TiledLayout<16>>(w, h);
+        expect_each_edge_numbered_once<MortonLayout>(w, h);
+    }
+}
+
+TEST(GridGraph, EdgeSetKeepsFirstInsertOrder) {
+    EdgeSet set;
+    set.reset(10);
+    for (std::size_t e : {7, 2, 7, 9, 2}) set.insert(e);
+    EXPECT_EQ(std::vector<std::uint32_t>(set.begin(), set.end()), (std::vector<std::uint32_t>{7, 2, 9}));
+    EXPECT_TRUE(set.contains(9));
+    EXPECT_FALSE(set.contains(3));
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(7));
+    set.insert(7);
+    EXPECT_EQ(set.size(), 1u);
+}
+
 TEST(Utils, SignAndAverage) {
     EXPECT_EQ(sign(-5), -1);
     EXPECT_EQ(sign(0), 0);
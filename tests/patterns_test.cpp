@@ -1,11 +1,29 @@
 #include <gtest/gtest.h>
 
+#include "router/box_cost.hpp"
+#include "router/cost_prefix.hpp"
 #include "router/ispd_data.hpp"
 #include "router/patterns.hpp"
+#include "router/soa_grid_graph.hpp"
+#include "router/utils.hpp"
 
 using namespace vlsigr;
 using namespace vlsigr::patterns;
 
+namespace {
+
+bool same_path(const TwoPin& a, const TwoPin& b) {
+    if (a.path.size() != b.path.size()) return false;
+    auto it = b.path.begin();
+    for (auto rp : a.path) {
+        auto q = *it++;
+        if (rp.x != q.x || rp.y != q.y || rp.hori != q.hori) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
 TEST(Patterns, Lshape) {
     TwoPin tp;
     tp.from.x = 0; tp.from.y = 0; tp.from.z = 0;
@@ -29,7 +47,7 @@ TEST(Patterns, LshapeCostPreference) {
     ASSERT_EQ(tp.path.size(), 4u);
     // Path should go (0,0)->(1,0)->(2,0)->(2,1)->(2,2) or via y=1 turn, but avoid x=1 vertical at y=0.
     // Ensure no vertical edge at (1,0)
-    for (auto& e : tp.path) {
+    for (const auto& e : tp.path) {
         ASSERT_FALSE(!e.hori && e.x == 1 && e.y == 0);
     }
 }
@@ -65,7 +83,7 @@ TEST(Patterns, ZshapeCostBias) {
     ASSERT_EQ(tp.path.size(), 4u);
     // Expect the first horizontal edge not at y=0
     bool has_hori_y0 = false;
-    for (auto& e : tp.path) if (e.hori && e.y == 0) has_hori_y0 = true;
+    for (const auto& e : tp.path) if (e.hori && e.y == 0) has_hori_y0 = true;
     EXPECT_FALSE(has_hori_y0);
 }
 
@@ -79,7 +97,7 @@ TEST(Patterns, MonotonicContinuity) {
     std::vector<std::pair<int,int>> nodes;
     int cx = tp.to.x, cy = tp.to.y;
     nodes.emplace_back(cx, cy);
-    for (auto& e : tp.path) {
+    for (const auto& e : tp.path) {
         if (e.hori) cx = e.x;      // horizontal edge (x,y)-(x+1,y) stored at left x
         else        cy = e.y;      // vertical edge (x,y)-(x,y+1) stored at lower y
         nodes.emplace_back(cx, cy);
@@ -95,4 +113,188 @@ TEST(Patterns, MonotonicContinuity) {
     }
 }
 
+TEST(Patterns, CostPrefixMatchesCostFn) {
+    // Integer costs sum exactly in either CostType, so both overloads must
+    // pick the same paths, before and after costs change under the sums.
+    SoAGridGraph grid;
+    grid.init(60, 50, Edge(4), Edge(4));
+    rng.seed(11);
+    auto randomize = [&](std::size_t stride, CostPrefix* prefix) {
+        for (std::size_t e = 0; e < grid.size(); e += stride) {
+            int x, y;
+            bool hori;
+            grid.idx2rp(e, x, y, hori);
+            if (!grid.contains(x, y, hori)) continue;  // layout padding
+            grid.cost(e) = to_edge_cost(randint<int>(1, 9));
+            if (prefix) prefix->touch(e);
+        }
+    };
+    randomize(1, nullptr);
+    CostPrefix prefix;
+    prefix.build(grid);
+    auto grid_cost = [&](int x, int y, bool hori) { return grid.cost(x, y, hori); };
+
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 300; i++) {
+            TwoPin tp;
+            tp.from = Point(randint<int>(0, 59), randint<int>(0, 49));
+            tp.to = Point(randint<int>(0, 59), randint<int>(0, 49));
+            TwoPin by_fn = tp, by_prefix = tp;
+            rng.seed(i);
+            Lshape(by_fn, grid_cost);
+            rng.seed(i);
+            Lshape(by_prefix, prefix);
+            ASSERT_TRUE(same_path(by_fn, by_prefix)) << "Lshape round " << round << " two-pin " << i;
+            Zshape(by_fn, grid_cost);
+            Zshape(by_prefix, prefix);
+            ASSERT_TRUE(same_path(by_fn, by_prefix)) << "Zshape round " << round << " two-pin " << i;
+        }
+        randomize(7, &prefix);
+    }
+}
+
+TEST(Patterns, MonotonicWavefrontFindsMinimumCost) {
+    // Integer costs with many ties: every path must cost what Monotonic's
+    // minimum costs, step monotonically from to back to from, and draw no rng.
+    SoAGridGraph grid;
+    grid.init(70, 40, Edge(4), Edge(4));
+    rng.seed(5);
+    for (std::size_t e = 0; e < grid.size(); e++) grid.cost(e) = to_edge_cost(randint<int>(1, 3));
+    auto grid_cost = [&](int x, int y, bool hori) { return grid.cost(x, y, hori); };
+    auto path_cost = [&](const TwoPin& tp) {
+        EdgeCost c = 0;
+        for (auto rp : tp.path) c = cost_add(c, grid.cost(rp.x, rp.y, rp.hori));
+        return c;
+    };
+    for (int i = 0; i < 300; i++) {
+        TwoPin tp;
+        tp.from = Point(randint<int>(0, 69), randint<int>(0, 39));
+        tp.to = Point(randint<int>(0, 69), randint<int>(0, 39));
+        TwoPin by_dp = tp, by_wave = tp;
+        Monotonic(by_dp, grid_cost);
+        auto state = rng;
+        MonotonicWavefront(by_wave, grid);
+        ASSERT_TRUE(rng == state);
+        ASSERT_EQ(by_wave.path.size(), by_dp.path.size());
+        ASSERT_EQ(path_cost(by_wave), path_cost(by_dp)) << "two-pin " << i;
+
+        // Walk from `to`: each edge must touch the current end, moving toward `from`.
+        auto f = tp.from, t = tp.to;
+        if (f.y > t.y) std::swap(f, t);
+        if (f.x > t.x) std::swap(f, t);
+        int x = t.x, y = t.y;
+        for (auto rp : by_wave.path) {
+            if (rp.hori) {
+                ASSERT_TRUE(rp.y == y && rp.x == x - 1);
+                x--;
+            } else {
+                ASSERT_TRUE(rp.x == x && (rp.y == y || rp.y == y - 1));
+                y = rp.y == y ? y + 1 : y - 1;
+            }
+        }
+        EXPECT_EQ(x, f.x);
+        EXPECT_EQ(y, f.y);
+
+        TwoPin again = tp;
+        MonotonicWavefront(again, grid);
+        ASSERT_TRUE(same_path(again, by_wave));
+    }
+}
+
+TEST(BoxCost, PackedPredecessorsTraceBackToSource) {
+    BoxScratch scratch;
+    {
+        // Dirty the scratch: a new box must start at kCostInf everywhere.
+        BoxCost big(0, 9, 0, 9, scratch);
+        for (int x = 0; x <= 9; x++)
+            for (int y = 0; y <= 9; y++) big.reach(x, y, 0, BoxCost::kUp);
+    }
+    BoxCost box(2, 5, 1, 3, scratch);
+    for (int x = 2; x <= 5; x++)
+        for (int y = 1; y <= 3; y++) ASSERT_EQ(box.cost(x, y), kCostInf);
+    EXPECT_EQ(scratch.cost.size(), 100u);
 
+    // From (5, 1): left to (2, 1), up to (2, 3), right to (4, 3); neighbours'
+    // 2-bit slots must not disturb each other.
+    box.cost(5, 1) = 0;
+    for (int x = 4; x >= 2; x--) box.reach(x, 1, 5 - x, BoxCost::kRight);
+    for (int y = 2; y <= 3; y++) box.reach(2, y, 2 + y, BoxCost::kDown);
+    for (int x = 3; x <= 4; x++) box.reach(x, 3, 3 + x, BoxCost::kLeft);
+    box.set_from(5, 3, BoxCost::kUp);
+    EXPECT_EQ(box.from(4, 1), BoxCost::kRight);
+    EXPECT_EQ(box.from(2, 2), BoxCost::kDown);
+    EXPECT_EQ(box.from(4, 3), BoxCost::kLeft);
+    EXPECT_EQ(box.cost(4, 3), 7);
+
+    SegmentPath path;
+    box.trace(path, Point(4, 3), Point(5, 1));
+    std::vector<RPoint> expect = {{3, 3, true}, {2, 3, true}, {2, 2, false}, {2, 1, false},
+                                  {2, 1, true}, {3, 1, true}, {4, 1, true}};
+    ASSERT_EQ(path.size(), expect.size());
+    std::size_t i = 0;
+    for (auto rp : path) {
+        EXPECT_EQ(rp.x, expect[i].x);
+        EXPECT_EQ(rp.y, expect[i].y);
+        EXPECT_EQ(rp.hori, expect[i].hori);
+        i++;
+    }
+
+    // (5, 2) was never reached (the scratch's stale directions must not be followed).
+    EXPECT_FALSE(box.reached(5, 2));
+    SegmentPath none;
+    box.trace(none, Point(5, 2), Point(5, 1));
+    EXPECT_EQ(none.size(), 0u);
+}
+
+TEST(SegmentPath, RunsReplayUnitEdgesInOrder) {
+    // Up x = 2 from y = 3 down to 1, right along y = 1, then a lone edge back.
+    std::vector<RPoint> edges = {{2, 2, false}, {2, 1, false}, {2, 1, true}, {3, 1, true},
+                                 {4, 1, true}, {4, 1, true}};
+    SegmentPath path;
+    for (auto& rp : edges) path.push_back(rp);
+    EXPECT_EQ(path.size(), edges.size());
+    ASSERT_EQ(path.segments().size(), 3u);
+    EXPECT_TRUE(path.segments()[0].back);
+    EXPECT_EQ(path.segments()[1].len, 3u);
+
+    std::size_t i = 0;
+    for (const auto& rp : path) {
+        ASSERT_LT(i, edges.size());
+        EXPECT_EQ(rp.x, edges[i].x);
+        EXPECT_EQ(rp.y, edges[i].y);
+        EXPECT_EQ(rp.hori, edges[i].hori);
+        i++;
+    }
+    EXPECT_EQ(i, edges.size());
+
+    EXPECT_TRUE(path.contains(RPoint(2, 2, false)));
+    EXPECT_TRUE(path.contains(RPoint(3, 1, true)));
+    EXPECT_FALSE(path.contains(RPoint(2, 3, false)));
+    EXPECT_FALSE(path.contains(RPoint(5, 1, true)));
+
+    SegmentPath runs;
+    runs.append_run(2, 2, false, 2, true);
+    runs.append_run(2, 1, true, 3);
+    runs.append_run(4, 1, true, 1);
+    ASSERT_EQ(runs.segments().size(), path.segments().size());
+    EXPECT_EQ(runs.size(), path.size());
+
+    SegmentPath other{{0, 0, true}};
+    const auto* storage = path.segments().data();
+    other.swap(path);
+    EXPECT_EQ(other.size(), edges.size());
+    EXPECT_EQ(other.segments().data(), storage);
+    EXPECT_EQ(path.size(), 1u);
+}
+
+TEST(SegmentPath, PatternRoutesAreFewRuns) {
+    TwoPin tp;
+    tp.from = Point(0, 0);
+    tp.to = Point(400, 250);
+    Lshape(tp);
+    EXPECT_EQ(tp.path.size(), 650u);
+    EXPECT_EQ(tp.path.segments().size(), 2u);
+    Zshape(tp);
+    EXPECT_EQ(tp.path.size(), 650u);
+    EXPECT_LE(tp.path.segments().size(), 3u);
+}
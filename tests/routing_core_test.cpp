@@ -1,12 +1,73 @@
 #include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include "router/routing_core.hpp"
+#include "router/checkpoint.hpp"
+#include "router/eco.hpp"
 #include "router/ispd_data.hpp"
+#include "router/utils.hpp"
 
 using namespace vlsigr;
 
+namespace {
+
+// Edge demand implied by the routed paths: nets using each edge.
+std::vector<int> recount_demand(const IspdData& data, const SoAGridGraph& grid) {
+    std::vector<int> demand(grid.size(), 0);
+    std::vector<int> last(grid.size(), -1);
+    for (std::size_t n = 0; n < data.nets.size(); n++)
+        for (auto& tp : data.nets[n].twopin)
+            for (const auto& rp : tp.path) {
+                auto i = grid.rp2idx(rp.x, rp.y, rp.hori);
+                if (last[i] != static_cast<int>(n)) {
+                    last[i] = static_cast<int>(n);
+                    demand[i]++;
+                }
+            }
+    return demand;
+}
+
+std::vector<int> grid_demand(const SoAGridGraph& grid) {
+    std::vector<int> demand;
+    for (std::size_t i = 0; i < grid.size(); i++) demand.push_back(grid.demand(i));
+    return demand;
+}
+
+// Every two-pin path as flat (x, y, hori) triples, in design order.
+std::vector<int> routed_paths(const IspdData& data) {
+    std::vector<int> out;
+    for (auto& net : data.nets)
+        for (auto& tp : net.twopin) {
+            out.push_back(-1);
+            for (const auto& rp : tp.path) {
+                out.push_back(rp.x);
+                out.push_back(rp.y);
+                out.push_back(rp.hori);
+            }
+        }
+    return out;
+}
+
+struct Preempted {};
+
+bool has_net(const IspdData& data, const std::string& name) {
+    for (auto& net : data.nets)
+        if (net.name == name) return true;
+    return false;
+}
+
+}  // namespace
+
 TEST(RoutingCore, CompleteRoutingPipeline) {
     // Small ISPD-like input: 3x2 grid, 1 layer, 1 net with 2 pins.
     std::string input = R"(grid 3 2 1
@@ -79,3 +140,231 @@ net0 0 2 1
         }
     });
 }
+
+TEST(RoutingCore, EcoReroutesOnlyTheDelta) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto data = parse_ispd_file(gr);
+    RoutingCore rc;
+    rc.route(data, false);
+    ASSERT_EQ(grid_demand(rc.grid()), recount_demand(data, rc.grid()));
+    std::vector<int> history;
+    for (std::size_t i = 0; i < rc.grid().size(); i++) history.push_back(rc.grid().he(i));
+    auto untouched = data.nets[5].twopin[0].path.size();
+    auto before = data.nets.size();
+
+    const std::string text = R"(# remove one net, move one, add one
+remove n0
+update n1 1 2 1
+3 3 1
+12 20 1
+add eco0 100 3 1
+1 22 1
+22 1 2
+12 12 1
+)";
+    auto delta = parse_netlist_delta_buffer(text.data(), text.size());
+    ASSERT_EQ(delta.removed.size(), 1u);
+    ASSERT_EQ(delta.updated.size(), 1u);
+    ASSERT_EQ(delta.added.size(), 1u);
+    EXPECT_EQ(delta.added[0].pins.size(), 3u);
+
+    auto st = rc.eco(data, delta);
+    EXPECT_EQ(st.removed, 1);
+    EXPECT_EQ(st.updated, 1);
+    EXPECT_EQ(st.added, 1);
+    EXPECT_GE(st.rerouted_nets, 2);
+    EXPECT_EQ(data.nets.size(), before);
+    EXPECT_EQ(data.numNet, static_cast<int>(data.nets.size()));
+    EXPECT_FALSE(has_net(data, "n0"));
+    ASSERT_TRUE(has_net(data, "eco0"));
+
+    for (auto& net : data.nets) {
+        if (net.name != "n1" && net.name != "eco0") continue;
+        EXPECT_EQ(net.twopin.size(), static_cast<std::size_t>(net.pin2D_count - 1));
+        for (auto& tp : net.twopin) EXPECT_FALSE(tp.path.empty());
+    }
+    auto& n1 = data.nets[0];
+    ASSERT_EQ(n1.name, "n1");
+    ASSERT_EQ(n1.pin2D_count, 2);
+    EXPECT_EQ(data.pin2D(n1)[1].x, 12);
+    EXPECT_EQ(data.pin2D(n1)[1].y, 20);
+    EXPECT_EQ(data.nets[4].name, "n5");
+    EXPECT_EQ(data.nets[4].twopin[0].path.size(), untouched);
+
+    // Demand matches the new paths and history carried over.
+    EXPECT_EQ(grid_demand(rc.grid()), recount_demand(data, rc.grid()));
+    for (std::size_t i = 0; i < rc.grid().size(); i++) {
+        EXPECT_EQ(rc.grid().used(i), 0);
+        EXPECT_GE(rc.grid().he(i), history[i]);
+    }
+}
+
+TEST(RoutingCore, ChainedEcosReuseNetState) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto data = parse_ispd_file(gr);
+    RoutingCore rc;
+    rc.route(data, false);
+    auto before = data.nets.size();
+
+    // Enough added nets to move data.nets, then drop and re-add names across
+    // ecos so wrappers, boxes and the name index are recycled.
+    NetlistDelta grow;
+    for (int i = 0; i < 40; i++)
+        grow.added.push_back({"g" + std::to_string(i), 200 + i, 1, {{i % 20, 1, 1}, {22 - i % 20, 21, 1}}});
+    rc.eco(data, grow);
+    ASSERT_EQ(data.nets.size(), before + 40);
+
+    NetlistDelta shrink;
+    shrink.removed = {"n0", "g3", "g39"};
+    shrink.updated.push_back({"g4", 204, 1, {{2, 2, 1}, {20, 2, 1}, {20, 20, 1}}});
+    rc.eco(data, shrink);
+    EXPECT_EQ(data.nets.size(), before + 37);
+    EXPECT_FALSE(has_net(data, "g3"));
+
+    NetlistDelta readd;
+    readd.removed = {"g4"};
+    readd.added.push_back({"n0", 0, 1, {{1, 1, 1}, {12, 12, 1}}});
+    readd.added.push_back({"g3", 203, 1, {{5, 5, 1}, {5, 18, 1}}});
+    auto st = rc.eco(data, readd);
+    EXPECT_EQ(st.removed, 1);
+    EXPECT_EQ(st.added, 2);
+    EXPECT_EQ(data.nets.size(), before + 38);
+    EXPECT_EQ(data.numNet, static_cast<int>(data.nets.size()));
+    EXPECT_TRUE(has_net(data, "n0"));
+    EXPECT_FALSE(has_net(data, "g4"));
+    EXPECT_EQ(data.nets.back().name, "g3");
+
+    // The index follows the renames: g4 is gone, n0 is back.
+    NetlistDelta stale;
+    stale.removed = {"g4"};
+    EXPECT_THROW(rc.eco(data, stale), std::runtime_error);
+    stale.removed = {"n0"};
+    EXPECT_NO_THROW(rc.eco(data, stale));
+
+    EXPECT_EQ(grid_demand(rc.grid()), recount_demand(data, rc.grid()));
+    for (auto& net : data.nets)
+        for (auto& tp : net.twopin) EXPECT_FALSE(tp.path.empty()) << net.name;
+    for (std::size_t i = 0; i < rc.grid().size(); i++) EXPECT_EQ(rc.grid().used(i), 0);
+}
+
+TEST(RoutingCore, EcoRejectsBadDeltaUntouched) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    auto data = parse_ispd_file(gr);
+    RoutingCore rc;
+
+    NetlistDelta delta;
+    delta.removed.push_back("n0");
+    EXPECT_THROW(rc.eco(data, delta), std::runtime_error);  // not routed yet
+
+    rc.route(data, false);
+    auto demand = grid_demand(rc.grid());
+    auto nets = data.nets.size();
+
+    delta.removed.push_back("no_such_net");
+    EXPECT_THROW(rc.eco(data, delta), std::runtime_error);
+    delta.removed = {"n0", "n0"};
+    EXPECT_THROW(rc.eco(data, delta), std::runtime_error);
+    delta.removed.clear();
+    delta.added.push_back({"n3", 3, 1, {{0, 0, 1}, {5, 5, 1}}});
+    EXPECT_THROW(rc.eco(data, delta), std::runtime_error);
+    delta.added[0] = {"outside", 50, 1, {{0, 0, 1}, {24, 5, 1}}};
+    EXPECT_THROW(rc.eco(data, delta), std::runtime_error);
+    EXPECT_EQ(grid_demand(rc.grid()), demand);
+    EXPECT_EQ(data.nets.size(), nets);
+
+    const std::string bad = "move n1 1 2 1\n";
+    EXPECT_THROW(parse_netlist_delta_buffer(bad.data(), bad.size()), std::runtime_error);
+    const std::string truncated = "add x 1 2 1\n0 0 1\n";
+    EXPECT_THROW(parse_netlist_delta_buffer(truncated.data(), truncated.size()), std::runtime_error);
+}
+
+TEST(RoutingCore, ResumeFromCheckpointMatchesUninterruptedRun) {
+    const std::string gr = "examples/complex.gr";
+    if (!std::filesystem::exists(gr)) GTEST_SKIP() << "Missing test input: " << gr;
+    const auto ckpt = (std::filesystem::temp_directory_path() / "vlsigr_routing.ckpt").string();
+
+    RoutingCore::CheckpointOptions opt;
+    opt.path = ckpt;
+    opt.interval_sec = 0;
+    int writes = 0;
+    opt.on_write = [&](const std::string&) { writes++; };
+
+    rng.seed(0);
+    auto full = parse_ispd_file(gr);
+    RoutingCore rc;
+    rc.set_checkpoint(opt);
+    rc.route(full, false);
+    const auto expected = routed_paths(full);
+    const auto expected_demand = grid_demand(rc.grid());
+    ASSERT_GE(writes, 3);
+    EXPECT_TRUE(is_checkpoint_file(ckpt));
+    EXPECT_FALSE(is_checkpoint_file(gr));
+
+    // Interrupt after the first, a middle and the last checkpoint, then resume
+    // with a disturbed RNG: the checkpoint must restore everything.
+    for (int stop_at : {1, (writes + 1) / 2, writes}) {
+        SCOPED_TRACE(stop_at);
+        int seen = 0;
+        opt.on_write = [&](const std::string&) {
+            if (++seen == stop_at) throw Preempted{};
+        };
+        rng.seed(0);
+        auto cut = parse_ispd_file(gr);
+        RoutingCore first;
+        first.set_checkpoint(opt);
+        EXPECT_THROW(first.route(cut, false), Preempted);
+
+        rng.seed(12345);
+        auto resumed = parse_ispd_file(gr);
+        RoutingCore second;
+        second.resume(resumed, ckpt);
+        EXPECT_EQ(routed_paths(resumed), expected);
+        EXPECT_EQ(grid_demand(second.grid()), expected_demand);
+    }
+
+    // A checkpoint only resumes the design it was taken on.
+    std::istringstream other(R"(grid 3 2 1
+vertical capacity 10
+horizontal capacity 20
+minimum width 1
+minimum spacing 1
+via spacing 1
+0 0 10 10
+num net 1
+net0 0 2 1
+0 0 1
+20 10 1
+0
+)");
+    auto small = parse_ispd(other);
+    RoutingCore wrong;
+    EXPECT_THROW(wrong.resume(small, ckpt), std::runtime_error);
+
+    // Corrupt iteration state or Config flags are rejected rather than run.
+    std::string bytes;
+    {
+        std::ifstream in(ckpt, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const std::size_t config_at = 8 + 4 + 8;  // magic, version, fingerprint
+    const std::size_t iteration_at = config_at + sizeof(RoutingCore::Config) + 4;
+    auto corrupt = [&](std::size_t at, const void* v, std::size_t n) {
+        std::string b = bytes;
+        std::memcpy(&b[at], v, n);
+        std::ofstream(ckpt, std::ios::binary) << b;
+        auto again = parse_ispd_file(gr);
+        RoutingCore rc;
+        EXPECT_THROW(rc.resume(again, ckpt), std::runtime_error);
+    };
+    const std::int32_t int_min = std::numeric_limits<std::int32_t>::min(), minus_one = -1;
+    const unsigned char two = 2;
+    corrupt(iteration_at, &int_min, sizeof(int_min));
+    corrupt(iteration_at + 8, &minus_one, sizeof(minus_one));  // stall
+    corrupt(config_at + offsetof(RoutingCore::Config, enable_hum), &two, 1);
+
+    std::error_code ec;
+    std::filesystem::remove(ckpt, ec);
+}
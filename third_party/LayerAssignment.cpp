@@ -30,7 +30,15 @@
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #include <cmath>
 #include <climits>
+#include <cstdio>
 #include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "router/segment_text.hpp"
 
 namespace LayerAssignment {
 
@@ -849,78 +857,143 @@ void Graph::solPrunning(vector<vector<Sol>> &set) const
     }
 }
 
-void Graph::output3Dresult(const char *filename)
+void Graph::get3Dresult(int netIndex, vector<Line> &lines, vector<Via3D> &vias, vector<Line> &tmpLines,
+                        vector<vector<int>> &tmpInfo) const
 {
-    FILE *fp = fopen(filename, "w");
-    int netArray_size = netArray.size();
+    const Net &cn = netArray[netIndex];
+    lines.clear();
+    vias.clear();
+    getStraight(lines, cn.edgeArray, tmpLines, tmpInfo);
+
     int minLay, maxLay;
-    vector<vector<int>> tmpInfo;
-    tmpInfo.resize(xNum);
-    for (int i = 0; i < xNum; i++)
-        tmpInfo[i].resize(yNum, -1);
+    int nodeArray_size = cn.nodeArray.size();
+    for (int j = 0; j < nodeArray_size; j++)
+    {
+        minLay = INT_MAX;
+        maxLay = -1;
+        const Node &cc = cn.nodeArray[j];
+
+        if (cc.pin)
+        {
+            minLay = min(cc.pinMinLay, minLay);
+            maxLay = max(cc.pinMaxLay, maxLay);
+        }
+
+        if (j != 0)
+        {
+            minLay = min(cn.edgeArray[j - 1].z, minLay);
+            maxLay = max(cn.edgeArray[j - 1].z, maxLay);
+        }
+
+        for (int k = 0; k < cc.degree; k++)
+        {
+            minLay = min(cn.edgeArray[cc.chiIndex[k] - 1].z, minLay);
+            maxLay = max(cn.edgeArray[cc.chiIndex[k] - 1].z, maxLay);
+        }
+        if (minLay != maxLay)
+            vias.push_back(Via3D{cc.x, cc.y, minLay, maxLay});
+    }
+}
+
+void Graph::format3Dresult(int begin, int end, string &out, vector<vector<int>> &tmpInfo) const
+{
     vector<Line> lines;
     vector<Line> tmpLines;
-
-    for (int i = 0; i < netArray_size; i++)
+    vector<Via3D> vias;
+    for (int i = begin; i < end; i++)
     {
-        Net &cn = netArray[i];
-        fprintf(fp, "%s %d\n", cn.name.c_str(), cn.netID);
-        lines.clear();
-        getStraight(lines, cn.edgeArray, tmpLines, tmpInfo);
+        const Net &cn = netArray[i];
+        out += cn.name;
+        out += ' ';
+        vlsigr::append_int(out, cn.netID);
+        out += '\n';
+        get3Dresult(i, lines, vias, tmpLines, tmpInfo);
 
         for (int j = 0; j < lines.size(); j++)
         {
-            Line &le = lines[j];
+            const Line &le = lines[j];
             if (le.hori)
             {
-                fprintf(fp, "(%d,%d,%d)-(%d,%d,%d)\n", le.x * cellW + blx, le.y * cellH + bly, le.z + 1,
-                        (le.x + le.len) * cellW + blx, le.y * cellH + bly, le.z + 1);
+                vlsigr::append_segment(out, le.x * cellW + blx, le.y * cellH + bly, le.z + 1,
+                                      (le.x + le.len) * cellW + blx, le.y * cellH + bly, le.z + 1);
             }
             else
             {
-                fprintf(fp, "(%d,%d,%d)-(%d,%d,%d)\n", le.x * cellW + blx, le.y * cellH + bly, le.z + 1,
-                        le.x * cellW + blx, (le.y + le.len) * cellH + bly, le.z + 1);
+                vlsigr::append_segment(out, le.x * cellW + blx, le.y * cellH + bly, le.z + 1,
+                                      le.x * cellW + blx, (le.y + le.len) * cellH + bly, le.z + 1);
             }
         }
-
-        int nodeArray_size = cn.nodeArray.size();
-        for (int j = 0; j < nodeArray_size; j++)
+        for (const Via3D &v : vias)
         {
-            minLay = INT_MAX;
-            maxLay = -1;
-            Node &cc = cn.nodeArray[j];
-
-            if (cc.pin)
-            {
-                minLay = min(cc.pinMinLay, minLay);
-                maxLay = max(cc.pinMaxLay, maxLay);
-            }
-
-            if (j != 0)
-            {
-                minLay = min(cn.edgeArray[j - 1].z, minLay);
-                maxLay = max(cn.edgeArray[j - 1].z, maxLay);
-            }
+            vlsigr::append_segment(out, v.x * cellW + blx, v.y * cellH + bly, v.minLay + 1,
+                                  v.x * cellW + blx, v.y * cellH + bly, v.maxLay + 1);
+        }
+        out += "!\n";
+    }
+}
 
-            for (int k = 0; k < cc.degree; k++)
-            {
-                minLay = min(cn.edgeArray[cc.chiIndex[k] - 1].z, minLay);
-                maxLay = max(cn.edgeArray[cc.chiIndex[k] - 1].z, maxLay);
-            }
-            if (minLay != maxLay)
+void Graph::output3Dresult(const char *filename, ThreadPool *pool)
+{
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL)
+        throw std::runtime_error(string("cannot open ") + filename);
+    std::unique_ptr<FILE, int (*)(FILE *)> file(fp, fclose);  // closed on throw
+    int netArray_size = netArray.size();
+    // Large chunks keep the per-task getStraight scratch grid cheap.
+    int chunk = max(1024, netArray_size / 64);
+
+    auto formatChunk = [this, netArray_size, chunk](int begin) {
+        vector<vector<int>> tmpInfo(xNum, vector<int>(yNum, -1));
+        string out;
+        out.reserve(static_cast<size_t>(chunk) * 128);
+        format3Dresult(begin, min(begin + chunk, netArray_size), out, tmpInfo);
+        return out;
+    };
+
+    // A short write (disk full, ...) throws.
+    auto write = [fp, filename](const string &out) {
+        if (fwrite(out.data(), 1, out.size(), fp) != out.size())
+            throw std::runtime_error(string("failed to write ") + filename);
+    };
+
+    if (pool == NULL)
+    {
+        for (int b = 0; b < netArray_size; b += chunk)
+            write(formatChunk(b));
+    }
+    else
+    {
+        // At most two chunks per worker in flight, so memory stays bounded by
+        // the window rather than the whole output. Written in net order.
+        const size_t window = 2 * max(1u, std::thread::hardware_concurrency());
+        std::deque<std::future<string>> parts;
+        int next = 0;
+        try
+        {
+            while (next < netArray_size || !parts.empty())
             {
-                fprintf(fp, "(%d,%d,%d)-(%d,%d,%d)\n", cc.x * cellW + blx, cc.y * cellH + bly, minLay + 1,
-                        cc.x * cellW + blx, cc.y * cellH + bly, maxLay + 1);
+                for (; next < netArray_size && parts.size() < window; next += chunk)
+                    parts.emplace_back(pool->enqueue(formatChunk, next));
+                string out = parts.front().get();
+                parts.pop_front();
+                write(out);
             }
         }
-        fprintf(fp, "!\n");
+        catch (...)
+        {
+            // formatChunk reads this Graph: let queued chunks finish first.
+            for (auto &f : parts)
+                f.wait();
+            throw;
+        }
     }
-    fclose(fp);
+    if (fclose(file.release()) != 0)
+        throw std::runtime_error(string("failed to write ") + filename);
 }
 
 #pragma GCC diagnostic pop
 
-inline void Graph::getStraight(vector<Line> &lines, vector<Edge> &edgeArray, vector<Line> &tmpLines, vector<vector<int>> &tmpInfo) const
+inline void Graph::getStraight(vector<Line> &lines, const vector<Edge> &edgeArray, vector<Line> &tmpLines, vector<vector<int>> &tmpInfo) const
 {
 
     int size = edgeArray.size();
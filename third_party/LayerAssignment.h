@@ -26,6 +26,7 @@
 #pragma once
 
 #include "ispdData.h"
+#include "ThreadPool.h"
 
 #include <vector>
 #include <string>
@@ -51,6 +52,7 @@ struct SolVia;
 struct Node;
 struct Pin;
 struct Line;
+struct Via3D;
 
 struct Graph {
 
@@ -96,7 +98,15 @@ struct Graph {
     vector<vector<SolVia>> solArray;
 
     // IO
-    void output3Dresult(const char *);
+    // Nets are formatted in parallel on `pool` (serially when null) and written
+    // in net order; the bytes do not depend on the pool. Throws
+    // std::runtime_error if the file cannot be opened or written.
+    void output3Dresult(const char *, ThreadPool *pool = nullptr);
+    void format3Dresult(int begin, int end, string &out, vector<vector<int>> &tmpInfo) const;
+    // Straight wires and vias of netArray[netIndex] in grid coordinates (what
+    // output3Dresult prints). tmpLines/tmpInfo are scratch; tmpInfo is xNum x yNum of -1.
+    void get3Dresult(int netIndex, vector<Line> &lines, vector<Via3D> &vias, vector<Line> &tmpLines,
+                     vector<vector<int>> &tmpInfo) const;
     void initialGraph();
     void BFS_net(vector<vector<int>> &nodeGraph, vector<vector<int>> &horEdgeG, vector<vector<int>> &verEdgeG, vector<vector<int>> &horEdgeLay,
                  vector<vector<int>> &verEdgeLay, vector<vector<int>> &pinGraph, vector<vector<int>> &pinMaxLay, vector<vector<int>> &pinMinLay, Net &nn);
@@ -126,7 +136,7 @@ struct Graph {
     inline int get3DHis(int x, int y, int z, int hori) const;
 
     inline int getCost(Edge &e, int lay) const;
-    inline void getStraight(vector<Line> &lines, vector<Edge> &edgeArray, vector<Line> &tmpLines, vector<vector<int>> &tmpInfo) const;
+    inline void getStraight(vector<Line> &lines, const vector<Edge> &edgeArray, vector<Line> &tmpLines, vector<vector<int>> &tmpInfo) const;
     int getTotalOverflow(int &maxOF, double &wieghtOF);
     int getSingleNetlVia(Net &cn);
     void ripUp(Net &nn);
@@ -198,6 +208,11 @@ struct Line {
     int len;
 };
 
+struct Via3D {
+    int x, y;
+    int minLay, maxLay;
+};
+
 struct GridEdge3D
 {
     int dem;